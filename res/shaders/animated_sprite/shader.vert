@@ -0,0 +1,88 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+struct AnimatedSpriteData {
+    vec2 position;
+    vec2 scale;
+    uint animation;
+    float startTime;
+    uint tint;
+    uint padding;
+};
+
+struct AnimationTableEntry {
+    uint firstFrame;
+    uint frameCount;
+    float duration;
+    uint padding;
+};
+
+struct AnimationTableFrame {
+    vec4 uv;
+    vec4 offset;
+    vec4 size;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    AnimatedSpriteData instances[];
+};
+
+layout(std430, set = 2, binding = 0) readonly buffer Animations {
+    AnimationTableEntry animations[];
+};
+
+layout(std430, set = 2, binding = 1) readonly buffer Frames {
+    AnimationTableFrame frames[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 vp;
+    float time;
+    int textureId;
+} pushConstants;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out int fragTextureId;
+
+vec2 positions[6] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2(-1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, -1.0),
+    vec2(-1.0, -1.0)
+);
+
+vec2 uvPositions[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(0.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 0.0),
+    vec2(0.0, 0.0)
+);
+
+void main() {
+    AnimatedSpriteData instance = instances[gl_InstanceIndex];
+    AnimationTableEntry animation = animations[instance.animation];
+
+    // Time within the loop, then the first frame ending after it
+    float t = mod(pushConstants.time - instance.startTime, animation.duration);
+    uint first = animation.firstFrame;
+    uint last = animation.firstFrame + animation.frameCount - 1;
+    while (first < last) {
+        uint middle = (first + last) / 2;
+        if (frames[middle].offset.w > t)
+            last = middle;
+        else
+            first = middle + 1;
+    }
+    AnimationTableFrame frame = frames[first];
+
+    vec2 position = instance.position + frame.offset.xy + instance.scale * frame.size.xy * positions[gl_VertexIndex];
+    gl_Position = pushConstants.vp * vec4(position, 0.0, 1.0);
+    fragColor = unpackUnorm4x8(instance.tint);
+    fragTexCoord = uvPositions[gl_VertexIndex] * frame.uv.zw + frame.uv.xy;
+    fragTextureId = pushConstants.textureId;
+}
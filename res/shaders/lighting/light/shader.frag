@@ -0,0 +1,69 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Must match LightingRenderer
+#define TILE_SIZE 16
+#define TILE_STRIDE 64
+
+struct Light {
+    vec2 position; // Pixels
+    float radius;  // Pixels
+    float intensity;
+    vec4 color;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Lights {
+    Light lights[];
+};
+
+// Per tile, a count followed by the light indices
+layout(std430, set = 0, binding = 1) readonly buffer Tiles {
+    uint tiles[];
+};
+
+layout(set = 0, binding = 2) uniform sampler2D occlusion;
+
+layout(push_constant) uniform PushConstants {
+    vec4 ambient;
+    vec2 targetSize;
+    uint tilesX;
+    uint shadowSteps;
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+float visibility(vec2 pixel, vec2 light) {
+    // March the occlusion mask from the pixel to the light, any occluder in between shadows it
+    vec2 step = (light - pixel) / float(pc.shadowSteps + 1);
+    vec2 position = pixel;
+    for (uint i = 0; i < pc.shadowSteps; i++) {
+        position += step;
+        if (texture(occlusion, position / pc.targetSize).r > 0.5)
+            return 0.0;
+    }
+    return 1.0;
+}
+
+void main() {
+    vec2 pixel = gl_FragCoord.xy;
+    uvec2 tileCoord = uvec2(pixel) / TILE_SIZE;
+    uint tile = (tileCoord.y * pc.tilesX + tileCoord.x) * TILE_STRIDE;
+
+    // Occluders themselves are left at the ambient level
+    bool occluded = texture(occlusion, pixel / pc.targetSize).r > 0.5;
+
+    vec3 color = pc.ambient.rgb;
+    uint count = occluded ? 0 : tiles[tile];
+    for (uint i = 0; i < count; i++) {
+        Light light = lights[tiles[tile + 1 + i]];
+
+        float distance = length(light.position - pixel);
+        if (distance >= light.radius)
+            continue;
+
+        float falloff = 1.0 - distance / light.radius;
+        color += light.color.rgb * light.intensity * falloff * falloff * visibility(pixel, light.position);
+    }
+
+    outColor = vec4(color, 1.0);
+}
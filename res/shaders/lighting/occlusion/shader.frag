@@ -0,0 +1,8 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) out float outOcclusion;
+
+void main() {
+    outOcclusion = 1.0;
+}
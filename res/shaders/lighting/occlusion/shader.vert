@@ -0,0 +1,12 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConstants {
+    mat4 vp;
+} pc;
+
+layout(location = 0) in vec2 inPosition;
+
+void main() {
+    gl_Position = pc.vp * vec4(inPosition, 0.0, 1.0);
+}
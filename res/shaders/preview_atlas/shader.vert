@@ -0,0 +1,42 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// One instance per thumbnail
+layout(location = 0) in mat4 inModel;   // Sprite box model, in the slot's own normalized coordinates
+layout(location = 4) in vec4 inSlot;    // Center and half size of the slot in the atlas
+layout(location = 5) in vec4 inUV;      // Position and size in the sprite texture
+layout(location = 6) in vec3 inTint;
+layout(location = 7) in int inTextureId;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out int fragTextureId;
+layout(location = 3) out vec2 fragSlotPos;
+
+vec2 positions[6] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2(-1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, -1.0),
+    vec2(-1.0, -1.0)
+);
+
+vec2 uvPositions[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(0.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 0.0),
+    vec2(0.0, 0.0)
+);
+
+void main() {
+    // Same placement as a standalone preview, then moved into the slot
+    vec4 slotPos = inModel * vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    fragSlotPos = slotPos.xy / slotPos.w;
+    gl_Position = vec4(inSlot.xy + fragSlotPos * inSlot.zw, 0.0, 1.0);
+    fragColor = vec4(inTint, 1.0);
+    fragTexCoord = uvPositions[gl_VertexIndex] * inUV.zw + inUV.xy;
+    fragTextureId = inTextureId;
+}
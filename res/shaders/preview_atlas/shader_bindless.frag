@@ -0,0 +1,20 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in int fragTextureId;
+layout(location = 3) in vec2 fragSlotPos;
+
+// Global texture table, instances of a single draw may use any entry
+layout(set = 0, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // Sprites larger than their slot must not spill into the neighbouring thumbnails
+    if (any(greaterThan(abs(fragSlotPos), vec2(1.0))))
+        discard;
+    outColor = fragColor * texture(textures[nonuniformEXT(fragTextureId)], fragTexCoord);
+}
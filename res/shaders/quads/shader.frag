@@ -2,9 +2,22 @@
 #extension GL_ARB_separate_shader_objects : enable
 
 layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragCoord;
+
+layout(push_constant) uniform PushConstants {
+    mat4 vp;
+    float lineWidth;
+    uint wire;
+} pushConstants;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
+    // Outlines keep the pixels within lineWidth of an edge, measured in screen pixels
+    if (pushConstants.wire != 0) {
+        vec2 edge = min(fragCoord, 1.0 - fragCoord) / max(fwidth(fragCoord), vec2(1e-6));
+        if (min(edge.x, edge.y) >= pushConstants.lineWidth)
+            discard;
+    }
     outColor = fragColor;
 }
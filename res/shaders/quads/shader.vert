@@ -1,16 +1,31 @@
 #version 450
 
-layout(location = 0) in vec2 inPosition;
-layout(location = 1) in vec4 inColor;
+// One instance per rectangle, two opposite corners
+layout(location = 0) in vec2 inPos1;
+layout(location = 1) in vec2 inPos2;
+layout(location = 2) in vec4 inColor;
 
-layout(binding = 0) uniform DirectVP  {
+layout(push_constant) uniform PushConstants {
     mat4 vp;
-} directVP;
+    float lineWidth;
+    uint wire;
+} pushConstants;
 
 layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragCoord;
+
+vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(0.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 0.0),
+    vec2(0.0, 0.0)
+);
 
 void main() {
-    
-    gl_Position = directVP.vp * vec4(inPosition, 0, 1);
+    vec2 corner = corners[gl_VertexIndex];
+    gl_Position = pushConstants.vp * vec4(mix(inPos1, inPos2, corner), 0.0, 1.0);
     fragColor = inColor;
+    fragCoord = corner;
 }
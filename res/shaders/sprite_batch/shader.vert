@@ -0,0 +1,49 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+struct SpriteBoxData {
+    mat4 m;
+    vec3 tint;
+    vec2 uvPos;
+    vec2 uvSize;
+    int textureId;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    SpriteBoxData instances[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 vp;
+} pushConstants;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out int fragTextureId;
+
+vec2 positions[6] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2(-1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, -1.0),
+    vec2(-1.0, -1.0)
+);
+
+vec2 uvPositions[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(0.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 0.0),
+    vec2(0.0, 0.0)
+);
+
+void main() {
+    // gl_InstanceIndex includes the first instance of the batch
+    SpriteBoxData instance = instances[gl_InstanceIndex];
+    gl_Position = pushConstants.vp * instance.m * vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    fragColor = vec4(instance.tint, 1.0);
+    fragTexCoord = uvPositions[gl_VertexIndex] * instance.uvSize + instance.uvPos;
+    fragTextureId = instance.textureId;
+}
@@ -0,0 +1,47 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Must match SpriteMeshTable::MAX_VERTICES
+#define MAX_VERTICES 8
+
+struct SpriteBoxData {
+    mat4 m;
+    vec3 tint;
+    vec2 uvPos;
+    vec2 uvSize;
+    int textureId;
+    int meshId;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    SpriteBoxData instances[];
+};
+
+// Frame hulls, MAX_VERTICES points normalized to the frame, mesh 0 is the full quad
+layout(std430, set = 2, binding = 0) readonly buffer Meshes {
+    vec2 meshVertices[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 vp;
+} pushConstants;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out int fragTextureId;
+
+void main() {
+    // gl_InstanceIndex includes the first instance of the batch
+    SpriteBoxData instance = instances[gl_InstanceIndex];
+
+    // Triangle fan around the first point, repeated last points make degenerate triangles
+    int triangle = gl_VertexIndex / 3;
+    int corner = gl_VertexIndex % 3;
+    int index = corner == 0 ? 0 : triangle + corner;
+    vec2 point = meshVertices[instance.meshId * MAX_VERTICES + index];
+
+    gl_Position = pushConstants.vp * instance.m * vec4(point * 2.0 - 1.0, 0.0, 1.0);
+    fragColor = vec4(instance.tint, 1.0);
+    fragTexCoord = point * instance.uvSize + instance.uvPos;
+    fragTextureId = instance.textureId;
+}
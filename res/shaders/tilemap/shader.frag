@@ -0,0 +1,15 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in int fragTextureId;
+
+// Fallback texture table, FALLBACK_TEXTURE_TABLE_SIZE entries, the index is uniform within a draw
+layout(set = 0, binding = 0) uniform sampler2D textures[16];
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = fragColor * texture(textures[fragTextureId], fragTexCoord);
+}
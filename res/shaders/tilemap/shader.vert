@@ -0,0 +1,35 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec2 tilePosition;
+layout(location = 1) in vec2 tileUvPos;
+layout(location = 2) in vec2 tileUvSize;
+layout(location = 3) in vec4 tileColor;
+layout(location = 4) in int tileTextureId;
+
+layout(push_constant) uniform PushConstants {
+    mat4 vp;
+    float tileSize;
+} pushConstants;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out int fragTextureId;
+
+// Unit square from the lower corner of the tile
+vec2 positions[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(0.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 0.0),
+    vec2(0.0, 0.0)
+);
+
+void main() {
+    vec2 corner = positions[gl_VertexIndex];
+    gl_Position = pushConstants.vp * vec4(tilePosition + corner * pushConstants.tileSize, 0.0, 1.0);
+    fragColor = tileColor;
+    fragTexCoord = corner * tileUvSize + tileUvPos;
+    fragTextureId = tileTextureId;
+}
@@ -0,0 +1,176 @@
+#include "alpha_benchmark.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+
+// Same loops as the editor's crop before the index, shrinking each side while its row or column is empty
+static bool scanBounds(const std::vector<uint8_t> & pixels, int width, int & x1, int & y1, int & x2, int & y2) {
+    auto solid = [&](int x, int y) { return pixels[((size_t) y * width + x) * 4 + 3] != 0; };
+    auto emptyRow = [&](int y) {
+        for (int x = x1; x < x2; x++)
+            if (solid(x, y))
+                return false;
+        return true;
+    };
+    auto emptyColumn = [&](int x) {
+        for (int y = y1; y < y2; y++)
+            if (solid(x, y))
+                return false;
+        return true;
+    };
+
+    int r1, r2, c1, c2;
+    for (r1 = y1; r1 < y2 && emptyRow(r1); r1++);
+    if (r1 == y2)
+        return false;
+    for (r2 = y2 - 1; r2 >= y1 && emptyRow(r2); r2--);
+    for (c1 = x1; c1 < x2 && emptyColumn(c1); c1++);
+    for (c2 = x2 - 1; c2 >= x1 && emptyColumn(c2); c2--);
+
+    x1 = c1;
+    y1 = r1;
+    x2 = c2 + 1;
+    y2 = r2 + 1;
+    return true;
+}
+
+
+AlphaBenchmark::AlphaBenchmark(uint32_t iterations_) {
+    iterations = std::max<uint32_t>(iterations_, 1);
+}
+
+/*
+ *  External methods
+ */
+
+void AlphaBenchmark::run() {
+    for (int size : {1024, 4096})
+        measure(size, 64);
+
+    for (int size : {256, 1024, 4096})
+        for (float density : {0.0f, 0.01f, 0.5f, 1.0f})
+            measureScan(size, 64, density);
+}
+
+/*
+ *  Internal methods
+ */
+
+void AlphaBenchmark::measure(int size, int tileSize) {
+    // A sprite sheet: each tile holds a blob of random size somewhere inside, a few tiles are empty
+    std::vector<uint8_t> pixels((size_t) size * size * 4, 0);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> extent(1, tileSize);
+    std::uniform_int_distribution<int> empty(0, 7);
+    for (int ty = 0; ty < size; ty += tileSize) {
+        for (int tx = 0; tx < size; tx += tileSize) {
+            if (empty(rng) == 0)
+                continue;
+            int w = extent(rng), h = extent(rng);
+            int x = tx + std::uniform_int_distribution<int>(0, tileSize - w)(rng);
+            int y = ty + std::uniform_int_distribution<int>(0, tileSize - h)(rng);
+            for (int j = y; j < y + h; j++)
+                for (int i = x; i < x + w; i++)
+                    pixels[((size_t) j * size + i) * 4 + 3] = 255;
+        }
+    }
+
+    std::vector<std::array<int, 4>> scanned, indexed;
+
+    auto start = Clock::now();
+    for (uint32_t it = 0; it < iterations; it++) {
+        scanned.clear();
+        for (int ty = 0; ty < size; ty += tileSize) {
+            for (int tx = 0; tx < size; tx += tileSize) {
+                int x1 = tx, y1 = ty, x2 = tx + tileSize, y2 = ty + tileSize;
+                if (scanBounds(pixels, size, x1, y1, x2, y2))
+                    scanned.push_back({x1, y1, x2, y2});
+            }
+        }
+    }
+    float scan = elapsed(start) / iterations;
+
+    AlphaIndex index;
+    start = Clock::now();
+    for (uint32_t it = 0; it < iterations; it++)
+        index.build(pixels.data(), size, size);
+    float build = elapsed(start) / iterations;
+
+    start = Clock::now();
+    for (uint32_t it = 0; it < iterations; it++) {
+        indexed.clear();
+        for (int ty = 0; ty < size; ty += tileSize) {
+            for (int tx = 0; tx < size; tx += tileSize) {
+                int x1 = tx, y1 = ty, x2 = tx + tileSize, y2 = ty + tileSize;
+                if (index.getBounds(x1, y1, x2, y2))
+                    indexed.push_back({x1, y1, x2, y2});
+            }
+        }
+    }
+    float query = elapsed(start) / iterations;
+
+    std::cout << "sheet: " << size << "x" << size << ", " << (size / tileSize) * (size / tileSize) << " tiles"
+        << (scanned == indexed ? "" : " (BOUNDS MISMATCH)") << std::endl;
+    std::cout << "  pixel scans: " << scan << " ms" << std::endl;
+    std::cout << "  index build: " << build << " ms" << std::endl;
+    std::cout << "  index crop: " << query << " ms (x" << scan / std::max(query, 1e-6f) << ")" << std::endl;
+}
+
+void AlphaBenchmark::measureScan(int size, int tileSize, float density) {
+    // Each pixel is solid with the given probability, with a random non zero alpha
+    std::vector<uint8_t> pixels((size_t) size * size * 4, 0);
+    std::mt19937 rng(7);
+    std::bernoulli_distribution solid(density);
+    std::uniform_int_distribution<int> alpha(1, 255);
+    for (size_t i = 0; i < (size_t) size * size; i++)
+        if (solid(rng))
+            pixels[i * 4 + 3] = alpha(rng);
+
+    std::cout << "scan: " << size << "x" << size << ", " << density * 100 << "% solid" << std::endl;
+
+    std::vector<uint8_t> referenceRows, referenceColumns;
+    std::vector<std::array<int, 4>> reference;
+    AlphaScan::Kernel best = AlphaScan::getKernel();
+    float scalarMasks = 0.0f;
+
+    for (AlphaScan::Kernel kernel : {AlphaScan::Kernel::SCALAR, AlphaScan::Kernel::SSE2, AlphaScan::Kernel::AVX2}) {
+        if (!AlphaScan::setKernel(kernel))
+            continue;
+
+        std::vector<uint8_t> rows, columns;
+        auto start = Clock::now();
+        for (uint32_t it = 0; it < iterations; it++)
+            AlphaScan::getOccupancy(pixels.data(), size, 0, 0, size, size, rows, columns);
+        float masks = elapsed(start) / iterations;
+
+        std::vector<std::array<int, 4>> cropped;
+        start = Clock::now();
+        for (uint32_t it = 0; it < iterations; it++) {
+            cropped.clear();
+            for (int ty = 0; ty < size; ty += tileSize) {
+                for (int tx = 0; tx < size; tx += tileSize) {
+                    int x1 = tx, y1 = ty, x2 = tx + tileSize, y2 = ty + tileSize;
+                    if (AlphaScan::getBounds(pixels.data(), size, x1, y1, x2, y2))
+                        cropped.push_back({x1, y1, x2, y2});
+                }
+            }
+        }
+        float crop = elapsed(start) / iterations;
+
+        bool match = true;
+        if (kernel == AlphaScan::Kernel::SCALAR) {
+            referenceRows = rows;
+            referenceColumns = columns;
+            reference = cropped;
+            scalarMasks = masks;
+        } else {
+            match = rows == referenceRows && columns == referenceColumns && cropped == reference;
+        }
+
+        std::cout << "  " << AlphaScan::getKernelName(kernel) << ": masks " << masks << " ms"
+            << " (" << (float) pixels.size() / std::max(masks, 1e-6f) / 1e6f << " GB/s, x" << scalarMasks / std::max(masks, 1e-6f) << ")"
+            << ", tile crop " << crop << " ms" << (match ? "" : " (MISMATCH)") << std::endl;
+    }
+
+    AlphaScan::setKernel(best);
+}
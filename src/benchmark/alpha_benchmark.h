@@ -0,0 +1,36 @@
+#ifndef ALPHA_BENCHMARK_H
+#define ALPHA_BENCHMARK_H
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "alpha_index.h"
+#include "alpha_scan.h"
+#include "benchmark_clock.h"
+
+namespace uengine::benchmark {
+
+    // Cropping every tile of a synthetic sheet to its solid pixels, at 1024 and 4096 pixels
+    // per side with 64 pixel tiles: pixel scans as the editor used to do, against an AlphaIndex.
+    // Then each AlphaScan kernel the CPU supports, over sheets of 256 to 4096 pixels per side
+    // from fully transparent to fully opaque: whole sheet occupancy masks and tile crops.
+    class AlphaBenchmark {
+        public:
+            AlphaBenchmark(uint32_t iterations);
+
+            void run();
+
+        private:
+            uint32_t iterations;
+
+            void measure(int size, int tileSize);
+            void measureScan(int size, int tileSize, float density);
+    };
+
+}
+
+#endif
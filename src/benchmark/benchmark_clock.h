@@ -0,0 +1,17 @@
+#ifndef BENCHMARK_CLOCK_H
+#define BENCHMARK_CLOCK_H
+
+#include <chrono>
+
+namespace uengine::benchmark {
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    // Milliseconds since start
+    inline float elapsed(std::chrono::time_point<Clock> start) {
+        return ((std::chrono::duration<float, std::milli>) (Clock::now() - start)).count();
+    }
+
+}
+
+#endif
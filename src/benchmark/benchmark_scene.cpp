@@ -0,0 +1,243 @@
+#include "benchmark_scene.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+namespace gh = uengine::graphics::helper;
+
+
+BenchmarkScene::BenchmarkScene(GraphicsBase * gb_, Sprite * sprite_, uint32_t count, bool gpuAnimation, bool meshes, bool cull, bool sorted) {
+    gb = gb_;
+    sprite = sprite_;
+
+    // Hulls are extracted from the pixels
+    if (meshes && sprite->isTextureLoaded() && !sprite->hasPixels())
+        sprite->freeTexture();
+    if (!sprite->isTextureLoaded())
+        sprite->loadTexture(meshes);
+
+    gb->createOffscreenRenderPass(VK_FORMAT_R8G8B8A8_UNORM, &renderPass);
+    float worldScale = cull && !gpuAnimation ? 10.0f : 1.0f;
+    setupSpriteBoxes(count, worldScale);
+
+    if (gpuAnimation) {
+        // Boxes are uploaded once, frames are then picked on the GPU
+        animationTable = new SpriteAnimationTable(gb, sprite);
+        animatedRenderer = new AnimatedSpriteRenderer(gb, &renderPass, animationTable, count);
+        for (auto spriteBox : spriteBoxes)
+            animatedRenderer->add(spriteBox);
+    } else {
+        if (meshes)
+            meshTable = new SpriteMeshTable(gb, sprite);
+        batch = new SpriteBatchRenderer(gb, &renderPass, count, meshTable);
+
+        if (cull) {
+            spatialHash = new SpriteSpatialHash(0.5f);
+            for (auto spriteBox : spriteBoxes)
+                spatialHash->insert(spriteBox);
+        }
+
+        // Higher boxes are further away, drawn first
+        if (sorted)
+            sortKeyEncoder = new SortKeyEncoder(worldScale, -worldScale);
+    }
+}
+
+BenchmarkScene::~BenchmarkScene() {
+    for (auto spriteBox : spriteBoxes)
+        delete spriteBox;
+    delete spatialHash;
+    delete sortKeyEncoder;
+    delete batch;
+    delete meshTable;
+    delete animatedRenderer;
+    delete animationTable;
+    if (offscreen.texture)
+        destroyOffscreen();
+    gb->destroyRenderPass(renderPass, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void BenchmarkScene::update() {
+    std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+    float dt = ((std::chrono::duration<float>) (now - lastTime)).count();
+    lastTime = now;
+
+    if (animatedRenderer) {
+        time += dt;
+        animatedRenderer->setTime(time);
+    } else {
+        // Off screen boxes are left alone, as a game would
+        std::vector<SpriteBox *> * boxes = &spriteBoxes;
+        if (spatialHash) {
+            visibleBoxes.clear();
+            spatialHash->query(vp, visibleBoxes);
+            boxes = &visibleBoxes;
+        }
+
+        batch->clear();
+        for (auto spriteBox : *boxes) {
+            spriteBox->update(dt);
+            if (sortKeyEncoder) {
+                SpriteBoxData * data = spriteBox->getData();
+                batch->add(spriteBox, sortKeyEncoder->encode(0, spriteBox->getPosition().y, 0, data->textureId));
+            } else {
+                batch->add(spriteBox);
+            }
+        }
+    }
+
+    updateTime = ((std::chrono::duration<float, std::milli>) (std::chrono::high_resolution_clock::now() - now)).count();
+}
+
+void BenchmarkScene::renderUI() {
+    ImGuiIO& io = ImGui::GetIO();
+
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+
+    ImGui::SetNextWindowPos(ImVec2(0, 0), 0);
+    ImGui::SetNextWindowSize(io.DisplaySize, 0);
+
+    ImGui::Begin("benchmark view", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove
+        | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoSavedSettings);
+
+    if (offscreen.texture) {
+        ImVec2 uv((float) offscreen.width / offscreen.target.width, (float) offscreen.height / offscreen.target.height);
+        ImGui::Image(offscreen.texture, ImVec2((float) offscreen.width, (float) offscreen.height), ImVec2(0, 0), uv);
+    }
+
+    ImGui::SetCursorPos(ImVec2(10, 10));
+    size_t uploaded = animatedRenderer
+        ? animatedRenderer->getUploadedBytes()
+        : batch->getInstanceCount() * sizeof(SpriteBoxData);
+    ImGui::Text("Sprites: %u%s", animatedRenderer ? animatedRenderer->getInstanceCount() : batch->getInstanceCount(),
+        animatedRenderer ? " (GPU animation)" : "");
+    if (spatialHash)
+        ImGui::Text("World: %u sprites, %u cells", spatialHash->getCount(), spatialHash->getCellCount());
+    ImGui::Text("Frame time: %.2f ms", gb->getFramePacer()->getFrameTime());
+    ImGui::Text("Update time: %.2f ms", updateTime);
+    ImGui::Text("Instance upload: %.1f KB", uploaded / 1024.0f);
+    if (batch)
+        ImGui::Text("Draws: %u%s", batch->getDrawCount(), sortKeyEncoder ? " (sorted)" : "");
+    if (meshTable)
+        ImGui::Text("Hull meshes: %.0f%% of the quad area", meshTable->getAreaRatio() * 100.0f);
+
+    ImGui::End();
+
+    ImGui::PopStyleVar(3);
+}
+
+void BenchmarkScene::render(VkCommandBuffer cb) {
+    if (!offscreen.texture || offscreen.width == 0 || offscreen.height == 0) {
+        return;
+    }
+
+    VkClearValue clearValues = {0};
+
+    VkRenderPassBeginInfo renderPassBeginInfo = gh::renderPassBeginInfo();
+    renderPassBeginInfo.renderPass = renderPass;
+    renderPassBeginInfo.framebuffer = offscreen.target.frameBuffer;
+    renderPassBeginInfo.renderArea.extent.width = offscreen.width;
+    renderPassBeginInfo.renderArea.extent.height = offscreen.height;
+    renderPassBeginInfo.clearValueCount = 1;
+    renderPassBeginInfo.pClearValues = &clearValues;
+
+    vkCmdBeginRenderPass(cb, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport = gh::viewport((float) offscreen.width, (float) offscreen.height, 0.0f, 1.0f);
+    vkCmdSetViewport(cb, 0, 1, &viewport);
+
+    VkRect2D scissor = gh::rect2D(offscreen.width, offscreen.height, 0, 0);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+
+    if (animatedRenderer)
+        animatedRenderer->render(cb);
+    else
+        batch->render(cb);
+
+    vkCmdEndRenderPass(cb);
+}
+
+void BenchmarkScene::resize(int32_t width, int32_t height) {
+    if (offscreen.width == width && offscreen.height == height)
+        return;
+
+    offscreen.width = width;
+    offscreen.height = height;
+
+    if (width == 0 || height == 0)
+        return;
+
+    // Render into a sub-rect of the current image as long as it fits, and only
+    // reallocate when growing past it or when most of it would go unused
+    bool fits = width <= offscreen.target.width && height <= offscreen.target.height;
+    bool wasteful = width < offscreen.target.width / 2 && height < offscreen.target.height / 2;
+    if (!offscreen.texture || !fits || wasteful) {
+        if (offscreen.texture)
+            destroyOffscreen();
+        setupOffscreen(width, height);
+    }
+
+    // Keep sprites square whatever the window ratio
+    float ratio = (float) width / height;
+    vp = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / ratio, 1.0f, 1.0f));
+    if (animatedRenderer)
+        animatedRenderer->setViewProjection(vp);
+    else
+        batch->setViewProjection(vp);
+}
+
+/*
+ *  Internal methods
+ */
+
+void BenchmarkScene::setupSpriteBoxes(uint32_t count, float worldScale) {
+    // Every animation of every skin, so batches mix frames from the whole sheet
+    std::vector<std::pair<Skin *, Animation *>> animations;
+    for (auto & [skinName, skin] : *sprite->getSkins())
+        for (auto & [animationName, animation] : *skin->getAnimations())
+            if (animation->getNbFrames() > 0)
+                animations.push_back({skin, animation});
+
+    if (animations.empty())
+        throw std::runtime_error("failed to setup benchmark, sprite has no animation!");
+
+    // Fixed seed, runs are comparable
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> phase(0.0f, 1.0f);
+    std::uniform_int_distribution<size_t> pick(0, animations.size() - 1);
+
+    spriteBoxes.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        auto & [skin, animation] = animations[pick(rng)];
+        FrameData * frameData = animation->getFrame(0)->getData();
+
+        SpriteBox * spriteBox = new SpriteBox(sprite);
+        spriteBox->setSkin(skin);
+        spriteBox->setAnimation(animation);
+        spriteBox->setPosition(position(rng) * 2.0f * worldScale, position(rng) * worldScale);
+        spriteBox->resize(0.02f / std::max(std::max(frameData->size.x, frameData->size.y), 1e-6f));
+        spriteBox->update(phase(rng) * frameData->dt * animation->getNbFrames());
+        spriteBoxes.push_back(spriteBox);
+    }
+}
+
+void BenchmarkScene::setupOffscreen(int32_t width, int32_t height) {
+    // A quarter of slack, rounded to 64 pixels, absorbs continuous window resizes
+    int32_t capacityWidth = ((width + width / 4 + 63) / 64) * 64;
+    int32_t capacityHeight = ((height + height / 4 + 63) / 64) * 64;
+    gb->createOffscreenTarget(renderPass, VK_FORMAT_R8G8B8A8_UNORM, capacityWidth, capacityHeight, &offscreen.target);
+
+    offscreen.texture = ImGui_ImplVulkan_AddTexture(offscreen.target.sampler, offscreen.target.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void BenchmarkScene::destroyOffscreen() {
+    gb->removeTexture(offscreen.texture);
+    gb->destroyOffscreenTarget(&offscreen.target);
+    offscreen.texture = nullptr;
+}
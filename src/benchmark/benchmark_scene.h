@@ -0,0 +1,78 @@
+#ifndef BENCHMARK_SCENE_H
+#define BENCHMARK_SCENE_H
+
+#include <array>
+#include <vector>
+#include <random>
+#include <chrono>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui.h"
+#include "imgui_impl_vulkan.h"
+#include "drawable.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+#include "sprite.h"
+#include "sprite_batch_renderer.h"
+#include "sprite_mesh_table.h"
+#include "sprite_spatial_hash.h"
+#include "sprite_animation_table.h"
+#include "animated_sprite_renderer.h"
+
+namespace uengine::benchmark {
+
+    // Fullscreen stress scene, animates and draws a large number of sprite boxes.
+    // With gpuAnimation the boxes are uploaded once and animated in the vertex shader.
+    // With meshes the boxes are drawn as their frame hull, cutting transparent overdraw.
+    // With cull the boxes are spread over a world 10 views wide and high, only the visible
+    // ones, found through a spatial hash, are animated and batched.
+    // With sorted the batched boxes are drawn back to front by height through sort keys.
+    class BenchmarkScene: public uengine::graphics::Drawable {
+        public:
+            BenchmarkScene(uengine::graphics::GraphicsBase * gb, uengine::graphics::Sprite * sprite, uint32_t count, bool gpuAnimation = false, bool meshes = false, bool cull = false, bool sorted = false);
+            ~BenchmarkScene();
+
+            void update();
+
+            // Virtual function implementation
+            void renderUI();
+            void render(VkCommandBuffer cb);
+            void resize(int32_t width, int32_t height);
+
+        private:
+            uengine::graphics::GraphicsBase * gb;
+            uengine::graphics::Sprite * sprite;
+            uengine::graphics::SpriteBatchRenderer * batch = nullptr;
+            uengine::graphics::SpriteMeshTable * meshTable = nullptr;
+            uengine::graphics::SpriteAnimationTable * animationTable = nullptr;
+            uengine::graphics::AnimatedSpriteRenderer * animatedRenderer = nullptr;
+            uengine::graphics::SpriteSpatialHash * spatialHash = nullptr;
+            uengine::graphics::SortKeyEncoder * sortKeyEncoder = nullptr;
+
+            std::vector<uengine::graphics::SpriteBox *> spriteBoxes;
+            std::vector<uengine::graphics::SpriteBox *> visibleBoxes;
+            glm::mat4 vp = glm::mat4(1.0f);
+            std::chrono::time_point<std::chrono::high_resolution_clock> lastTime = std::chrono::high_resolution_clock::now();
+            float updateTime = 0.0f; // CPU time spent animating and batching, in milliseconds
+            float time = 0.0f;
+
+            VkRenderPass renderPass;
+
+            struct Offscreen {
+                int32_t width = 0, height = 0; // Rendered area, the target is allocated with slack
+                uengine::graphics::OffscreenTarget target;
+                ImTextureID texture = nullptr;
+            } offscreen;
+
+            void setupSpriteBoxes(uint32_t count, float worldScale);
+            void setupOffscreen(int32_t width, int32_t height);
+            void destroyOffscreen();
+    };
+
+}
+
+#endif
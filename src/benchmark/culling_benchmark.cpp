@@ -0,0 +1,111 @@
+#include "culling_benchmark.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+
+
+CullingBenchmark::CullingBenchmark(Sprite * sprite_, uint32_t count, uint32_t iterations_) {
+    sprite = sprite_;
+    iterations = std::max<uint32_t>(iterations_, 1);
+
+    setupSpriteBoxes(count);
+}
+
+CullingBenchmark::~CullingBenchmark() {
+    for (auto spriteBox : spriteBoxes)
+        delete spriteBox;
+}
+
+/*
+ *  External methods
+ */
+
+void CullingBenchmark::run() {
+    // The view is the [-1, 1] square, the world WORLD_SIZE times wider and taller
+    glm::mat4 vp = glm::mat4(1.0f);
+    glm::vec2 viewLower(-1.0f), viewUpper(1.0f);
+    std::vector<SpriteBox *> visible;
+    visible.reserve(spriteBoxes.size());
+
+    // Brute force, what renderers do today
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        visible.clear();
+        for (auto spriteBox : spriteBoxes) {
+            glm::vec2 lower, upper;
+            spriteBox->getBounds(lower, upper);
+            if (lower.x <= viewUpper.x && upper.x >= viewLower.x && lower.y <= viewUpper.y && upper.y >= viewLower.y)
+                visible.push_back(spriteBox);
+        }
+    }
+    float bruteForce = elapsed(start) / iterations;
+    size_t bruteForceCount = visible.size();
+
+    // Cells of about a quarter of the view
+    SpriteSpatialHash hash(0.5f);
+    start = Clock::now();
+    for (auto spriteBox : spriteBoxes)
+        hash.insert(spriteBox);
+    float build = elapsed(start);
+
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        visible.clear();
+        hash.query(vp, visible);
+    }
+    float query = elapsed(start) / iterations;
+
+    // 1% of the boxes move every frame
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> step(-0.01f, 0.01f);
+    std::uniform_int_distribution<size_t> pick(0, spriteBoxes.size() - 1);
+    size_t moving = std::max<size_t>(spriteBoxes.size() / 100, 1);
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < moving; j++) {
+            SpriteBox * spriteBox = spriteBoxes[pick(rng)];
+            spriteBox->move(step(rng), step(rng));
+            hash.update(spriteBox);
+        }
+    }
+    float update = elapsed(start) / iterations;
+
+    std::cout << "sprites: " << spriteBoxes.size() << ", visible: " << bruteForceCount << " / " << visible.size()
+        << ", cells: " << hash.getCellCount() << std::endl;
+    std::cout << "brute force: " << bruteForce << " ms/frame" << std::endl;
+    std::cout << "spatial hash: " << query << " ms/frame query, " << update << " ms/frame to move " << moving
+        << " boxes, " << build << " ms build, speedup: " << bruteForce / query << "x" << std::endl;
+}
+
+/*
+ *  Internal methods
+ */
+
+void CullingBenchmark::setupSpriteBoxes(uint32_t count) {
+    std::vector<std::pair<Skin *, Animation *>> animations;
+    for (auto & [skinName, skin] : *sprite->getSkins())
+        for (auto & [animationName, animation] : *skin->getAnimations())
+            if (animation->getNbFrames() > 0)
+                animations.push_back({skin, animation});
+
+    if (animations.empty())
+        throw std::runtime_error("failed to setup benchmark, sprite has no animation!");
+
+    // Fixed seed, runs are comparable
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-WORLD_SIZE, WORLD_SIZE);
+    std::uniform_int_distribution<size_t> pick(0, animations.size() - 1);
+
+    spriteBoxes.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        auto & [skin, animation] = animations[pick(rng)];
+        FrameData * frameData = animation->getFrame(0)->getData();
+
+        SpriteBox * spriteBox = new SpriteBox(sprite);
+        spriteBox->setSkin(skin);
+        spriteBox->setAnimation(animation);
+        spriteBox->setPosition(position(rng), position(rng));
+        spriteBox->resize(0.02f / std::max(std::max(frameData->size.x, frameData->size.y), 1e-6f));
+        spriteBoxes.push_back(spriteBox);
+    }
+}
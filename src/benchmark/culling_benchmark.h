@@ -0,0 +1,40 @@
+#ifndef CULLING_BENCHMARK_H
+#define CULLING_BENCHMARK_H
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "sprite.h"
+#include "sprite_spatial_hash.h"
+#include "benchmark_clock.h"
+
+namespace uengine::benchmark {
+
+    // CPU cost of finding the visible sprite boxes of a large world, with 1% of it on screen:
+    // testing every box against the view versus querying a SpriteSpatialHash
+    class CullingBenchmark {
+        public:
+            static constexpr float WORLD_SIZE = 10.0f; // In views per side
+
+            CullingBenchmark(uengine::graphics::Sprite * sprite, uint32_t count, uint32_t iterations);
+            ~CullingBenchmark();
+
+            void run();
+
+        private:
+            uengine::graphics::Sprite * sprite;
+            uint32_t iterations;
+            std::vector<uengine::graphics::SpriteBox *> spriteBoxes;
+
+            void setupSpriteBoxes(uint32_t count);
+    };
+
+}
+
+#endif
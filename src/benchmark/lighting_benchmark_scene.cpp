@@ -0,0 +1,125 @@
+#include "lighting_benchmark_scene.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+
+
+LightingBenchmarkScene::LightingBenchmarkScene(GraphicsBase * gb_, uint32_t lightCount, uint32_t occluderCount) {
+    gb = gb_;
+    lighting = new LightingRenderer(gb, lightCount);
+
+    // Fixed seed, runs are comparable
+    std::mt19937 rng(42);
+    setupLights(lightCount, rng);
+    setupOccluders(occluderCount, rng);
+}
+
+LightingBenchmarkScene::~LightingBenchmarkScene() {
+    delete lighting;
+}
+
+/*
+ *  External methods
+ */
+
+void LightingBenchmarkScene::update() {
+    std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+    time += ((std::chrono::duration<float>) (now - lastTime)).count();
+    lastTime = now;
+
+    lighting->clearLights();
+    for (auto & moving : lights) {
+        float angle = moving.phase + moving.speed * time;
+        moving.light.position = moving.center + moving.orbit * glm::vec2(cos(angle), sin(angle));
+        lighting->addLight(moving.light);
+    }
+}
+
+void LightingBenchmarkScene::renderUI() {
+    ImGuiIO& io = ImGui::GetIO();
+
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+
+    ImGui::SetNextWindowPos(ImVec2(0, 0), 0);
+    ImGui::SetNextWindowSize(io.DisplaySize, 0);
+
+    ImGui::Begin("lighting benchmark view", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove
+        | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoSavedSettings);
+
+    if (lighting->getTexture()) {
+        ImGui::Image(lighting->getTexture(), io.DisplaySize, ImVec2(0, 0), lighting->getTextureUV());
+    }
+
+    ImGui::SetCursorPos(ImVec2(10, 10));
+    ImGui::Text("Lights: %u / %zu visible", lighting->getLightCount(), lights.size());
+    ImGui::Text("Occluder triangles: %u", lighting->getOccluderTriangleCount());
+    ImGui::Text("Lights per tile: %.2f", lighting->getAverageLightsPerTile());
+    ImGui::Text("Frame time: %.2f ms", gb->getFramePacer()->getFrameTime());
+    ImGui::Text("Cull time: %.2f ms", lighting->getCullTime());
+
+    ImGui::End();
+
+    ImGui::PopStyleVar(3);
+}
+
+void LightingBenchmarkScene::render(VkCommandBuffer cb) {
+    lighting->render(cb);
+}
+
+void LightingBenchmarkScene::resize(int32_t width, int32_t height) {
+    lighting->resize(width, height);
+
+    if (width == 0 || height == 0)
+        return;
+
+    // Keep lights round whatever the window ratio
+    float ratio = (float) width / height;
+    lighting->setViewProjection(glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / ratio, 1.0f, 1.0f)));
+}
+
+/*
+ *  Internal methods
+ */
+
+void LightingBenchmarkScene::setupLights(uint32_t count, std::mt19937 & rng) {
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    lights.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        MovingLight moving;
+        moving.center = glm::vec2(position(rng) * 2.0f, position(rng));
+        moving.orbit = 0.05f + unit(rng) * 0.2f;
+        moving.speed = (unit(rng) - 0.5f) * 2.0f;
+        moving.phase = unit(rng) * 6.2831853f;
+        moving.light.color = glm::vec3(0.3f) + 0.7f * glm::vec3(unit(rng), unit(rng), unit(rng));
+        moving.light.radius = 0.1f + unit(rng) * 0.2f;
+        moving.light.intensity = 0.5f + unit(rng) * 0.5f;
+        moving.light.position = moving.center;
+        lights.push_back(moving);
+    }
+}
+
+void LightingBenchmarkScene::setupOccluders(uint32_t count, std::mt19937 & rng) {
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.01f, 0.06f);
+    std::uniform_real_distribution<float> angle(0.0f, 3.1415927f);
+
+    // Rotated boxes
+    for (uint32_t i = 0; i < count; i++) {
+        glm::vec2 center(position(rng) * 2.0f, position(rng));
+        glm::vec2 half(size(rng), size(rng));
+        float a = angle(rng);
+        glm::vec2 u(cos(a), sin(a));
+        glm::vec2 v(-u.y, u.x);
+
+        lighting->addOccluder({
+            center - u * half.x - v * half.y,
+            center + u * half.x - v * half.y,
+            center + u * half.x + v * half.y,
+            center - u * half.x + v * half.y
+        });
+    }
+}
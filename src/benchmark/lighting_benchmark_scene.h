@@ -0,0 +1,57 @@
+#ifndef LIGHTING_BENCHMARK_SCENE_H
+#define LIGHTING_BENCHMARK_SCENE_H
+
+#include <array>
+#include <vector>
+#include <random>
+#include <chrono>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui.h"
+#include "imgui_impl_vulkan.h"
+#include "drawable.h"
+#include "graphics_base.h"
+#include "lighting_renderer.h"
+
+namespace uengine::benchmark {
+
+    // Fullscreen stress scene for the LightingRenderer, moving lights over static box occluders
+    class LightingBenchmarkScene: public uengine::graphics::Drawable {
+        public:
+            LightingBenchmarkScene(uengine::graphics::GraphicsBase * gb, uint32_t lightCount, uint32_t occluderCount);
+            ~LightingBenchmarkScene();
+
+            void update();
+
+            // Virtual function implementation
+            void renderUI();
+            void render(VkCommandBuffer cb);
+            void resize(int32_t width, int32_t height);
+
+        private:
+            uengine::graphics::GraphicsBase * gb;
+            uengine::graphics::LightingRenderer * lighting;
+
+            struct MovingLight {
+                uengine::graphics::Light light;
+                glm::vec2 center;
+                float orbit;  // Radius of the circle followed by the light
+                float speed;  // Radians per second
+                float phase;
+            };
+            std::vector<MovingLight> lights;
+
+            std::chrono::time_point<std::chrono::high_resolution_clock> lastTime = std::chrono::high_resolution_clock::now();
+            float time = 0.0f;
+
+            void setupLights(uint32_t count, std::mt19937 & rng);
+            void setupOccluders(uint32_t count, std::mt19937 & rng);
+    };
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "outline_benchmark.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+
+
+OutlineBenchmark::OutlineBenchmark(Sprite * sprite_, uint32_t iterations_) {
+    sprite = sprite_;
+    iterations = std::max<uint32_t>(iterations_, 1);
+
+    if (!sprite->hasPixels())
+        throw std::runtime_error("failed to setup benchmark, sprite texture was loaded without its pixels!");
+}
+
+/*
+ *  External methods
+ */
+
+void OutlineBenchmark::run() {
+    uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+    uint32_t frames = 0;
+
+    float single = measure(1, frames);
+    float parallel = measure(threads, frames);
+
+    // Size of the result, the same for both runs
+    size_t outlines = 0, vertices = 0;
+    float hullArea = 0.0f;
+    for (auto & [skinName, skin] : *sprite->getSkins()) {
+        for (auto & [animationName, animation] : *skin->getAnimations()) {
+            for (auto frame : *animation->getFrames()) {
+                for (auto & outline : *frame->getOutlines()) {
+                    outlines++;
+                    vertices += outline.size();
+                }
+                hullArea += OutlineExtractor::area(*frame->getHull());
+            }
+        }
+    }
+
+    // Hulls are normalized to their frame, the ratio is the fragment count left compared to quads
+    std::cout << "frames: " << frames << ", outlines: " << outlines << ", vertices: " << vertices
+        << ", hull area: " << (frames ? hullArea / frames * 100.0f : 100.0f) << "% of quads" << std::endl;
+    std::cout << "1 thread: " << single << " ms/sheet, " << frames * 1000.0f / single << " frames/s" << std::endl;
+    std::cout << threads << " threads: " << parallel << " ms/sheet, " << frames * 1000.0f / parallel << " frames/s"
+        << ", speedup: " << single / parallel << "x" << std::endl;
+}
+
+/*
+ *  Internal methods
+ */
+
+float OutlineBenchmark::measure(uint32_t threads, uint32_t & frames) {
+    OutlineExtractor extractor;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+        frames = extractor.extractSprite(sprite, true, threads);
+
+    return ((std::chrono::duration<float, std::milli>) (std::chrono::high_resolution_clock::now() - start)).count() / iterations;
+}
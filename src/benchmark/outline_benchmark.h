@@ -0,0 +1,31 @@
+#ifndef OUTLINE_BENCHMARK_H
+#define OUTLINE_BENCHMARK_H
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "sprite.h"
+#include "outline_extractor.h"
+
+namespace uengine::benchmark {
+
+    // CPU throughput of outline extraction over every frame of a sprite sheet,
+    // single threaded then on every hardware thread
+    class OutlineBenchmark {
+        public:
+            OutlineBenchmark(uengine::graphics::Sprite * sprite, uint32_t iterations);
+
+            void run();
+
+        private:
+            uengine::graphics::Sprite * sprite;
+            uint32_t iterations;
+
+            float measure(uint32_t threads, uint32_t & frames); // Milliseconds per pass
+    };
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "slice_benchmark.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+
+static void fill(std::vector<uint8_t> & pixels, int size, int x1, int y1, int x2, int y2, uint8_t alpha) {
+    for (int y = y1; y < y2; y++)
+        for (int x = x1; x < x2; x++)
+            pixels[((size_t) y * size + x) * 4 + 3] = alpha;
+}
+
+
+SliceBenchmark::SliceBenchmark(uint32_t iterations_) {
+    iterations = std::max<uint32_t>(iterations_, 1);
+}
+
+/*
+ *  External methods
+ */
+
+void SliceBenchmark::run() {
+    for (int size : {2048, 8192})
+        measure(size);
+}
+
+/*
+ *  Internal methods
+ */
+
+void SliceBenchmark::measure(int size) {
+    // 128 pixel cells, frames of odd columns sit in the lower half of their cell and reach into
+    // the next one, so no empty column separates them. Each frame is a body with a hole and a
+    // hat two rows above it, frames stay at least 8 pixels apart.
+    const int cell = 128;
+    std::vector<uint8_t> pixels((size_t) size * size * 4, 0);
+    std::vector<Slice> expected;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> offset(0, 16), width(40, 150), height(20, 40);
+    for (int cy = 0; cy < size; cy += cell) {
+        for (int cx = 0, column = 0; cx < size; cx += cell, column++) {
+            int x1 = cx + offset(rng);
+            int x2 = std::min(x1 + width(rng), size);
+            int y1 = cy + (column % 2 ? 68 : 4);
+            int y2 = y1 + 12 + height(rng);
+            fill(pixels, size, x1, y1 + 10, x2, y2, 255);
+            fill(pixels, size, x1 + 8, y1 + 14, x1 + 12, y1 + 18, 0);
+            fill(pixels, size, x1 + 4, y1, x1 + 20, y1 + 8, 128);
+            uint32_t area = (x2 - x1) * (y2 - y1 - 10) - 16 + 16 * 8;
+            expected.push_back({x1, y1, x2, y2, area});
+        }
+    }
+
+    SlicerSettings settings;
+    settings.mergeDistance = 3;
+    settings.minArea = 4;
+
+    uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::cout << "sheet: " << size << "x" << size << ", " << expected.size() << " frames" << std::endl;
+
+    for (uint32_t threads : {1u, hardwareThreads}) {
+        SpriteSlicer slicer(settings, threads);
+        std::vector<Slice> slices;
+
+        auto start = Clock::now();
+        for (uint32_t it = 0; it < iterations; it++)
+            slices = slicer.slice(pixels.data(), size, 0, 0, size, size);
+        float time = elapsed(start) / iterations;
+
+        // Staggered frames make two lines per row of cells, compare by position
+        auto byPosition = [](const Slice & a, const Slice & b) { return a.y1 != b.y1 ? a.y1 < b.y1 : a.x1 < b.x1; };
+        std::sort(slices.begin(), slices.end(), byPosition);
+        std::sort(expected.begin(), expected.end(), byPosition);
+
+        bool match = slices.size() == expected.size();
+        for (size_t i = 0; match && i < slices.size(); i++) {
+            const Slice & a = slices[i], & b = expected[i];
+            match = a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2 && a.area == b.area;
+        }
+
+        std::cout << "  " << threads << (threads == 1 ? " thread: " : " threads: ") << time << " ms, "
+            << slices.size() << " slices" << (match ? "" : " (MISMATCH)") << std::endl;
+
+        if (threads == hardwareThreads)
+            break;
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef SLICE_BENCHMARK_H
+#define SLICE_BENCHMARK_H
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "sprite_slicer.h"
+#include "benchmark_clock.h"
+
+namespace uengine::benchmark {
+
+    // Slicing whole synthetic sheets of 2048 and 8192 pixels per side into frames, on one
+    // thread and on every hardware thread. Frames overlap horizontally with their neighbours
+    // and are made of parts a few pixels apart with holes, each must come out as one slice.
+    class SliceBenchmark {
+        public:
+            SliceBenchmark(uint32_t iterations);
+
+            void run();
+
+        private:
+            uint32_t iterations;
+
+            void measure(int size);
+    };
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "sort_benchmark.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+
+
+SortBenchmark::SortBenchmark(uint32_t iterations_) {
+    iterations = std::max<uint32_t>(iterations_, 1);
+}
+
+/*
+ *  External methods
+ */
+
+void SortBenchmark::run() {
+    for (size_t count : {10000, 100000, 1000000})
+        measure(count);
+}
+
+/*
+ *  Internal methods
+ */
+
+void SortBenchmark::measure(size_t count) {
+    // A few layers, depth spread over the view, two pipelines and a 16 texture atlas set
+    SortKeyEncoder encoder(1.0f, -1.0f);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint32_t> layer(0, 3);
+    std::uniform_real_distribution<float> depth(-1.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> pipeline(0, 1);
+    std::uniform_int_distribution<uint32_t> texture(0, 15);
+
+    std::vector<uint64_t> keys(count);
+    for (auto & key : keys)
+        key = encoder.encode(layer(rng), depth(rng), pipeline(rng), texture(rng));
+
+    std::vector<uint32_t> order;
+    RadixSorter single(1);
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+        single.sort(keys, order);
+    float radix = elapsed(start) / iterations;
+
+    std::vector<uint32_t> parallelOrder;
+    RadixSorter parallel;
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+        parallel.sort(keys, parallelOrder);
+    float radixParallel = elapsed(start) / iterations;
+
+    // Pairs are rebuilt every iteration, as the instance list would be
+    std::vector<std::pair<uint64_t, uint32_t>> pairs(count);
+    float stdSort = 0.0f, stdStableSort = 0.0f;
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < count; j++)
+            pairs[j] = {keys[j], (uint32_t) j};
+        start = Clock::now();
+        std::sort(pairs.begin(), pairs.end());
+        stdSort += elapsed(start);
+
+        for (size_t j = 0; j < count; j++)
+            pairs[j] = {keys[j], (uint32_t) j};
+        start = Clock::now();
+        std::stable_sort(pairs.begin(), pairs.end(), [](auto & a, auto & b) { return a.first < b.first; });
+        stdStableSort += elapsed(start);
+    }
+    stdSort /= iterations;
+    stdStableSort /= iterations;
+
+    // Both radix sorts are stable, they must match the stable sort exactly
+    bool matches = order == parallelOrder;
+    for (size_t j = 0; j < count && matches; j++)
+        matches = pairs[j].second == order[j];
+
+    std::cout << "instances: " << count << (matches ? "" : " (ORDER MISMATCH)") << std::endl;
+    std::cout << "  radix, 1 thread: " << radix << " ms" << std::endl;
+    std::cout << "  radix, " << std::max(std::thread::hardware_concurrency(), 1u) << " threads: " << radixParallel << " ms" << std::endl;
+    std::cout << "  std::sort: " << stdSort << " ms (x" << stdSort / std::max(radixParallel, 1e-6f) << ")" << std::endl;
+    std::cout << "  std::stable_sort: " << stdStableSort << " ms (x" << stdStableSort / std::max(radixParallel, 1e-6f) << ")" << std::endl;
+}
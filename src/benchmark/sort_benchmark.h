@@ -0,0 +1,31 @@
+#ifndef SORT_BENCHMARK_H
+#define SORT_BENCHMARK_H
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "sprite_sort.h"
+#include "benchmark_clock.h"
+
+namespace uengine::benchmark {
+
+    // Draw key sorting at 10k, 100k and 1M instances: radix sort on one thread and on every
+    // hardware thread, against std::sort and std::stable_sort of (key, index) pairs
+    class SortBenchmark {
+        public:
+            SortBenchmark(uint32_t iterations);
+
+            void run();
+
+        private:
+            uint32_t iterations;
+
+            void measure(size_t count);
+    };
+
+}
+
+#endif
@@ -0,0 +1,183 @@
+#include "tilemap_benchmark_scene.h"
+
+using namespace uengine::benchmark;
+using namespace uengine::graphics;
+namespace gh = uengine::graphics::helper;
+
+static constexpr float TILE_SIZE = 1.0f / 32.0f; // 64 tiles over the view height
+
+
+TilemapBenchmarkScene::TilemapBenchmarkScene(GraphicsBase * gb_, Sprite * sprite_, uint32_t size) {
+    gb = gb_;
+    sprite = sprite_;
+
+    // Tile types bake the texture index
+    if (!sprite->isTextureLoaded())
+        sprite->loadTexture(false);
+
+    gb->createOffscreenRenderPass(VK_FORMAT_R8G8B8A8_UNORM, &renderPass);
+    tilemap = new TilemapRenderer(gb, &renderPass, size, size, TILE_SIZE);
+    tilemap->setOrigin(glm::vec2(-0.5f * size * TILE_SIZE));
+    setupTiles();
+}
+
+TilemapBenchmarkScene::~TilemapBenchmarkScene() {
+    delete tilemap;
+    if (offscreen.texture)
+        destroyOffscreen();
+    gb->destroyRenderPass(renderPass, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void TilemapBenchmarkScene::update() {
+    std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+    time += ((std::chrono::duration<float>) (now - lastTime)).count();
+    lastTime = now;
+
+    // Circle over most of the map at about half a view per second
+    float radius = 0.35f * tilemap->getWidth() * TILE_SIZE;
+    float angle = time / std::max(radius, 1.0f);
+    camera = radius * glm::vec2(cos(angle), sin(angle));
+    tilemap->setViewProjection(glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / ratio, 1.0f, 1.0f))
+        * glm::translate(glm::mat4(1.0f), glm::vec3(-camera, 0.0f)));
+
+    // Edits in view, their chunks are rebuilt this frame
+    glm::vec2 center = camera / TILE_SIZE + 0.5f * glm::vec2((float) tilemap->getWidth(), (float) tilemap->getHeight());
+    glm::vec2 half = glm::vec2(ratio, 1.0f) / TILE_SIZE;
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> type(0, tilemap->getTileTypeCount() - 1);
+    for (uint32_t i = 0; i < EDITS_PER_FRAME; i++) {
+        glm::vec2 tile = center + half * glm::vec2(offset(rng), offset(rng));
+        if (tile.x >= 0.0f && tile.y >= 0.0f)
+            tilemap->setTile((uint32_t) tile.x, (uint32_t) tile.y, type(rng));
+    }
+
+    updateTime = ((std::chrono::duration<float, std::milli>) (std::chrono::high_resolution_clock::now() - now)).count();
+}
+
+void TilemapBenchmarkScene::renderUI() {
+    ImGuiIO& io = ImGui::GetIO();
+
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+
+    ImGui::SetNextWindowPos(ImVec2(0, 0), 0);
+    ImGui::SetNextWindowSize(io.DisplaySize, 0);
+
+    ImGui::Begin("tilemap benchmark view", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove
+        | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoSavedSettings);
+
+    if (offscreen.texture) {
+        ImVec2 uv((float) offscreen.width / offscreen.target.width, (float) offscreen.height / offscreen.target.height);
+        ImGui::Image(offscreen.texture, ImVec2((float) offscreen.width, (float) offscreen.height), ImVec2(0, 0), uv);
+    }
+
+    // Statistics are those of the last render
+    ImGui::SetCursorPos(ImVec2(10, 10));
+    ImGui::Text("Map: %ux%u tiles, %u chunks", tilemap->getWidth(), tilemap->getHeight(), tilemap->getChunkCount());
+    ImGui::Text("Visible chunks: %u, rebuilt: %u", tilemap->getVisibleChunkCount(), tilemap->getRebuiltChunkCount());
+    ImGui::Text("Tiles drawn: %u", tilemap->getDrawnTileCount());
+    ImGui::Text("Buffer pages: %u", tilemap->getPageCount());
+    ImGui::Text("Frame time: %.2f ms", gb->getFramePacer()->getFrameTime());
+    ImGui::Text("Update time: %.2f ms", updateTime);
+
+    ImGui::End();
+
+    ImGui::PopStyleVar(3);
+}
+
+void TilemapBenchmarkScene::render(VkCommandBuffer cb) {
+    if (!offscreen.texture || offscreen.width == 0 || offscreen.height == 0) {
+        return;
+    }
+
+    VkClearValue clearValues = {0};
+
+    VkRenderPassBeginInfo renderPassBeginInfo = gh::renderPassBeginInfo();
+    renderPassBeginInfo.renderPass = renderPass;
+    renderPassBeginInfo.framebuffer = offscreen.target.frameBuffer;
+    renderPassBeginInfo.renderArea.extent.width = offscreen.width;
+    renderPassBeginInfo.renderArea.extent.height = offscreen.height;
+    renderPassBeginInfo.clearValueCount = 1;
+    renderPassBeginInfo.pClearValues = &clearValues;
+
+    vkCmdBeginRenderPass(cb, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport = gh::viewport((float) offscreen.width, (float) offscreen.height, 0.0f, 1.0f);
+    vkCmdSetViewport(cb, 0, 1, &viewport);
+
+    VkRect2D scissor = gh::rect2D(offscreen.width, offscreen.height, 0, 0);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+
+    tilemap->render(cb);
+
+    vkCmdEndRenderPass(cb);
+}
+
+void TilemapBenchmarkScene::resize(int32_t width, int32_t height) {
+    if (offscreen.width == width && offscreen.height == height)
+        return;
+
+    offscreen.width = width;
+    offscreen.height = height;
+
+    if (width == 0 || height == 0)
+        return;
+
+    // Render into a sub-rect of the current image as long as it fits, and only
+    // reallocate when growing past it or when most of it would go unused
+    bool fits = width <= offscreen.target.width && height <= offscreen.target.height;
+    bool wasteful = width < offscreen.target.width / 2 && height < offscreen.target.height / 2;
+    if (!offscreen.texture || !fits || wasteful) {
+        if (offscreen.texture)
+            destroyOffscreen();
+        setupOffscreen(width, height);
+    }
+
+    // Keep tiles square whatever the window ratio, applied on the next update
+    ratio = (float) width / height;
+}
+
+/*
+ *  Internal methods
+ */
+
+void TilemapBenchmarkScene::setupTiles() {
+    // One tile type per frame of the whole sheet
+    for (auto & [skinName, skin] : *sprite->getSkins())
+        for (auto & [animationName, animation] : *skin->getAnimations())
+            for (int32_t i = 0; i < animation->getNbFrames(); i++) {
+                FrameData * data = animation->getFrame(i)->getData();
+                tilemap->addTileType(sprite, data->uvPos, data->uvSize);
+            }
+
+    if (tilemap->getTileTypeCount() < 2)
+        throw std::runtime_error("failed to setup benchmark, sprite has no frame!");
+
+    // A quarter of the tiles left empty
+    std::uniform_int_distribution<uint32_t> type(0, (tilemap->getTileTypeCount() - 1) * 4 / 3);
+    for (uint32_t y = 0; y < tilemap->getHeight(); y++)
+        for (uint32_t x = 0; x < tilemap->getWidth(); x++) {
+            uint32_t t = type(rng);
+            tilemap->setTile(x, y, t < tilemap->getTileTypeCount() ? t : TilemapRenderer::EMPTY_TILE);
+        }
+}
+
+void TilemapBenchmarkScene::setupOffscreen(int32_t width, int32_t height) {
+    // A quarter of slack, rounded to 64 pixels, absorbs continuous window resizes
+    int32_t capacityWidth = ((width + width / 4 + 63) / 64) * 64;
+    int32_t capacityHeight = ((height + height / 4 + 63) / 64) * 64;
+    gb->createOffscreenTarget(renderPass, VK_FORMAT_R8G8B8A8_UNORM, capacityWidth, capacityHeight, &offscreen.target);
+
+    offscreen.texture = ImGui_ImplVulkan_AddTexture(offscreen.target.sampler, offscreen.target.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void TilemapBenchmarkScene::destroyOffscreen() {
+    gb->removeTexture(offscreen.texture);
+    gb->destroyOffscreenTarget(&offscreen.target);
+    offscreen.texture = nullptr;
+}
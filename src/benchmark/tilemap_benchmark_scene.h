@@ -0,0 +1,68 @@
+#ifndef TILEMAP_BENCHMARK_SCENE_H
+#define TILEMAP_BENCHMARK_SCENE_H
+
+#include <array>
+#include <vector>
+#include <random>
+#include <chrono>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui.h"
+#include "imgui_impl_vulkan.h"
+#include "drawable.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+#include "sprite.h"
+#include "tilemap_renderer.h"
+
+namespace uengine::benchmark {
+
+    // Fullscreen stress scene for the TilemapRenderer, a square map filled with the frames of a
+    // sprite. The camera circles over the map so chunks keep coming into view, and a few tiles
+    // around it are edited every frame so visible chunks get rebuilt.
+    class TilemapBenchmarkScene: public uengine::graphics::Drawable {
+        public:
+            static constexpr uint32_t EDITS_PER_FRAME = 64;
+
+            TilemapBenchmarkScene(uengine::graphics::GraphicsBase * gb, uengine::graphics::Sprite * sprite, uint32_t size);
+            ~TilemapBenchmarkScene();
+
+            void update();
+
+            // Virtual function implementation
+            void renderUI();
+            void render(VkCommandBuffer cb);
+            void resize(int32_t width, int32_t height);
+
+        private:
+            uengine::graphics::GraphicsBase * gb;
+            uengine::graphics::Sprite * sprite;
+            uengine::graphics::TilemapRenderer * tilemap;
+
+            std::mt19937 rng = std::mt19937(42); // Fixed seed, runs are comparable
+            glm::vec2 camera = glm::vec2(0.0f);
+            float ratio = 1.0f;
+            std::chrono::time_point<std::chrono::high_resolution_clock> lastTime = std::chrono::high_resolution_clock::now();
+            float updateTime = 0.0f; // CPU time spent editing, in milliseconds
+            float time = 0.0f;
+
+            VkRenderPass renderPass;
+
+            struct Offscreen {
+                int32_t width = 0, height = 0; // Rendered area, the target is allocated with slack
+                uengine::graphics::OffscreenTarget target;
+                ImTextureID texture = nullptr;
+            } offscreen;
+
+            void setupTiles();
+            void setupOffscreen(int32_t width, int32_t height);
+            void destroyOffscreen();
+    };
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "alpha_index.h"
+
+using AlphaIndex = uengine::graphics::AlphaIndex;
+
+/*
+ *  External methods
+ */
+
+void AlphaIndex::build(const uint8_t * pixels, int width_, int height_, uint8_t threshold) {
+    width = width_;
+    height = height_;
+    wordsPerRow = (width + 63) / 64;
+
+    // Every word and corner is written below except the first row and column of the table,
+    // rebuilding at the same size clears nothing else
+    bits.resize((size_t) wordsPerRow * height);
+    table.resize((size_t) (width + 1) * (height + 1));
+    std::fill(table.begin(), table.begin() + width + 1, 0);
+
+    // Each corner adds its row's running count to the corner above it, bits are gathered
+    // a word at a time so the bitmap is written once
+    for (int y = 0; y < height; y++) {
+        const uint8_t * alpha = pixels + (size_t) y * width * 4 + 3;
+        uint64_t * row = bits.data() + (size_t) y * wordsPerRow;
+        const uint32_t * above = table.data() + (size_t) y * (width + 1) + 1;
+        uint32_t * corners = table.data() + (size_t) (y + 1) * (width + 1) + 1;
+        corners[-1] = 0;
+
+        uint32_t rowCount = 0;
+        for (int x0 = 0; x0 < width; x0 += 64) {
+            int end = std::min(x0 + 64, width);
+            uint64_t word = 0;
+            for (int x = x0; x < end; x++) {
+                uint32_t solid = alpha[x * 4] >= threshold;
+                word |= (uint64_t) solid << (x - x0);
+                rowCount += solid;
+                corners[x] = above[x] + rowCount;
+            }
+            row[x0 >> 6] = word;
+        }
+    }
+}
+
+void AlphaIndex::clear() {
+    width = height = 0;
+    wordsPerRow = 0;
+    bits = std::vector<uint64_t>();
+    table = std::vector<uint32_t>();
+}
+
+bool AlphaIndex::isBuilt() {
+    return !table.empty();
+}
+
+int AlphaIndex::getWidth() {
+    return width;
+}
+
+int AlphaIndex::getHeight() {
+    return height;
+}
+
+bool AlphaIndex::isSolid(int x, int y) {
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        return false;
+    return (bits[(size_t) y * wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+uint32_t AlphaIndex::count(int x1, int y1, int x2, int y2) {
+    x1 = std::clamp(x1, 0, width);
+    x2 = std::clamp(x2, 0, width);
+    y1 = std::clamp(y1, 0, height);
+    y2 = std::clamp(y2, 0, height);
+    if (x1 >= x2 || y1 >= y2)
+        return 0;
+    return at(x2, y2) - at(x1, y2) - at(x2, y1) + at(x1, y1);
+}
+
+bool AlphaIndex::isEmpty(int x1, int y1, int x2, int y2) {
+    return count(x1, y1, x2, y2) == 0;
+}
+
+bool AlphaIndex::isRowEmpty(int x1, int x2, int y) {
+    return count(x1, y, x2, y + 1) == 0;
+}
+
+bool AlphaIndex::isColumnEmpty(int y1, int y2, int x) {
+    return count(x, y1, x + 1, y2) == 0;
+}
+
+bool AlphaIndex::getBounds(int & x1, int & y1, int & x2, int & y2) {
+    int bx1 = std::clamp(x1, 0, width);
+    int bx2 = std::clamp(x2, 0, width);
+    int by1 = std::clamp(y1, 0, height);
+    int by2 = std::clamp(y2, 0, height);
+    if (count(bx1, by1, bx2, by2) == 0)
+        return false;
+
+    // Counts from one side are monotonic, each edge is the first position where they become non zero
+    int lo = by1, hi = by2 - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (count(bx1, by1, bx2, mid + 1) > 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    int top = lo;
+
+    lo = top, hi = by2 - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (count(bx1, mid, bx2, by2) > 0)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    int bottom = lo + 1;
+
+    lo = bx1, hi = bx2 - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (count(bx1, top, mid + 1, bottom) > 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    int left = lo;
+
+    lo = left, hi = bx2 - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (count(mid, top, bx2, bottom) > 0)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    int right = lo + 1;
+
+    x1 = left;
+    y1 = top;
+    x2 = right;
+    y2 = bottom;
+    return true;
+}
+
+/*
+ *  Internal methods
+ */
+
+uint32_t AlphaIndex::at(int x, int y) {
+    return table[(size_t) y * (width + 1) + x];
+}
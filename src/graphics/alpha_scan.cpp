@@ -0,0 +1,198 @@
+#include "alpha_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ALPHA_SCAN_X86
+#endif
+
+using AlphaScan = uengine::graphics::AlphaScan;
+
+/*
+ *  Row kernels, OR the solid pixels of one row into the column masks and return whether any was solid
+ */
+
+static bool scanRowScalar(const uint8_t * row, int count, uint8_t * columns, uint8_t threshold) {
+    uint8_t any = 0;
+    for (int x = 0; x < count; x++) {
+        uint8_t solid = row[x * 4 + 3] >= threshold;
+        columns[x] |= solid;
+        any |= solid;
+    }
+    return any;
+}
+
+#ifdef ALPHA_SCAN_X86
+
+static bool scanRowSSE2(const uint8_t * row, int count, uint8_t * columns, uint8_t threshold) {
+    // Alpha is the top byte of each pixel, shifted down then packed to 16 bytes.
+    // Solid is alpha >= threshold, that is max(alpha, threshold) == alpha, exact down to threshold 0.
+    const __m128i bound = _mm_set1_epi8((char) threshold);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i any = zero;
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i * p = (const __m128i *) (row + x * 4);
+        __m128i a = _mm_srli_epi32(_mm_loadu_si128(p), 24);
+        __m128i b = _mm_srli_epi32(_mm_loadu_si128(p + 1), 24);
+        __m128i c = _mm_srli_epi32(_mm_loadu_si128(p + 2), 24);
+        __m128i d = _mm_srli_epi32(_mm_loadu_si128(p + 3), 24);
+        __m128i alpha = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+
+        __m128i solid = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(alpha, bound), alpha), one);
+        __m128i * column = (__m128i *) (columns + x);
+        _mm_storeu_si128(column, _mm_or_si128(_mm_loadu_si128(column), solid));
+        any = _mm_or_si128(any, solid);
+    }
+
+    bool tail = scanRowScalar(row + x * 4, count - x, columns + x, threshold);
+    return tail || _mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF;
+}
+
+__attribute__((target("avx2")))
+static bool scanRowAVX2(const uint8_t * row, int count, uint8_t * columns, uint8_t threshold) {
+    // Packing works within 128 bit lanes, the final permute puts the 32 alpha bytes back in pixel order
+    const __m256i bound = _mm256_set1_epi8((char) threshold);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    __m256i any = zero;
+
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i * p = (const __m256i *) (row + x * 4);
+        __m256i a = _mm256_srli_epi32(_mm256_loadu_si256(p), 24);
+        __m256i b = _mm256_srli_epi32(_mm256_loadu_si256(p + 1), 24);
+        __m256i c = _mm256_srli_epi32(_mm256_loadu_si256(p + 2), 24);
+        __m256i d = _mm256_srli_epi32(_mm256_loadu_si256(p + 3), 24);
+        __m256i alpha = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        alpha = _mm256_permutevar8x32_epi32(alpha, order);
+
+        __m256i solid = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(alpha, bound), alpha), one);
+        __m256i * column = (__m256i *) (columns + x);
+        _mm256_storeu_si256(column, _mm256_or_si256(_mm256_loadu_si256(column), solid));
+        any = _mm256_or_si256(any, solid);
+    }
+
+    // Remaining pixels stay in this function, calling the SSE2 kernel would mix legacy and VEX encodings
+    uint8_t tail = 0;
+    for (; x < count; x++) {
+        uint8_t solid = row[x * 4 + 3] >= threshold;
+        columns[x] |= solid;
+        tail |= solid;
+    }
+    return tail || !_mm256_testz_si256(any, any);
+}
+
+#endif
+
+AlphaScan::Kernel AlphaScan::kernel = AlphaScan::Kernel::SCALAR;
+AlphaScan::RowKernel AlphaScan::rowKernel = nullptr;
+
+/*
+ *  External methods
+ */
+
+AlphaScan::Kernel AlphaScan::getKernel() {
+    // Best supported kernel, picked once on first use. As a local static, concurrent first
+    // calls, such as the slicer's band threads, wait for it rather than racing on the choice
+    static const bool picked = []() {
+        for (Kernel candidate : {Kernel::AVX2, Kernel::SSE2, Kernel::SCALAR}) {
+            if (supports(candidate)) {
+                kernel = candidate;
+                rowKernel = select(candidate);
+                break;
+            }
+        }
+        return true;
+    }();
+    (void) picked;
+    return kernel;
+}
+
+bool AlphaScan::setKernel(Kernel kernel_) {
+    // The default choice must not override this one later
+    getKernel();
+    if (!supports(kernel_))
+        return false;
+    kernel = kernel_;
+    rowKernel = select(kernel_);
+    return true;
+}
+
+const char * AlphaScan::getKernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SSE2: return "SSE2";
+        case Kernel::AVX2: return "AVX2";
+        default: return "scalar";
+    }
+}
+
+void AlphaScan::getOccupancy(const uint8_t * pixels, int stride, int x1, int y1, int x2, int y2,
+                             std::vector<uint8_t> & rows, std::vector<uint8_t> & columns, uint8_t threshold) {
+    getKernel();
+    int width = std::max(x2 - x1, 0);
+    int height = std::max(y2 - y1, 0);
+    rows.assign(height, 0);
+    columns.assign(width, 0);
+
+    for (int y = 0; y < height; y++)
+        rows[y] = rowKernel(pixels + ((size_t) (y1 + y) * stride + x1) * 4, width, columns.data(), threshold);
+}
+
+bool AlphaScan::getBounds(const uint8_t * pixels, int stride, int & x1, int & y1, int & x2, int & y2, uint8_t threshold) {
+    std::vector<uint8_t> rows, columns;
+    getOccupancy(pixels, stride, x1, y1, x2, y2, rows, columns, threshold);
+
+    auto first = std::find_if(rows.begin(), rows.end(), [](uint8_t r) { return r != 0; });
+    if (first == rows.end())
+        return false;
+    auto last = std::find_if(rows.rbegin(), rows.rend(), [](uint8_t r) { return r != 0; });
+    auto left = std::find_if(columns.begin(), columns.end(), [](uint8_t c) { return c != 0; });
+    auto right = std::find_if(columns.rbegin(), columns.rend(), [](uint8_t c) { return c != 0; });
+
+    int x0 = x1, y0 = y1;
+    y1 = y0 + (first - rows.begin());
+    y2 = y0 + (rows.rend() - last);
+    x1 = x0 + (left - columns.begin());
+    x2 = x0 + (columns.rend() - right);
+    return true;
+}
+
+bool AlphaScan::isEmpty(const uint8_t * pixels, int stride, int x1, int y1, int x2, int y2, uint8_t threshold) {
+    // Rows stop at the first solid one, the column masks are scratch
+    getKernel();
+    int width = std::max(x2 - x1, 0);
+    std::vector<uint8_t> columns(width, 0);
+    for (int y = y1; y < y2; y++) {
+        if (rowKernel(pixels + ((size_t) y * stride + x1) * 4, width, columns.data(), threshold))
+            return false;
+    }
+    return true;
+}
+
+/*
+ *  Internal methods
+ */
+
+bool AlphaScan::supports(Kernel kernel) {
+    switch (kernel) {
+#ifdef ALPHA_SCAN_X86
+        case Kernel::SSE2: return __builtin_cpu_supports("sse2");
+        case Kernel::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        case Kernel::SCALAR: return true;
+        default: return false;
+    }
+}
+
+AlphaScan::RowKernel AlphaScan::select(Kernel kernel) {
+    switch (kernel) {
+#ifdef ALPHA_SCAN_X86
+        case Kernel::SSE2: return scanRowSSE2;
+        case Kernel::AVX2: return scanRowAVX2;
+#endif
+        default: return scanRowScalar;
+    }
+}
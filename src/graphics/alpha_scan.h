@@ -0,0 +1,44 @@
+#ifndef ALPHA_SCAN_H
+#define ALPHA_SCAN_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace uengine::graphics {
+
+    // Streaming scans of the alpha channel of RGBA8 pixels, for areas without an AlphaIndex.
+    // Each row of the rect is read once, alpha bytes are gathered 16 (SSE2) or 32 (AVX2)
+    // pixels at a time and merged into row and column occupancy masks; columns never cost
+    // a strided walk. The kernel is picked at runtime from what the CPU supports.
+    // Rects are half open, [x1, x2) x [y1, y2), and must lie inside the pixels.
+    // Pixels with alpha at or above the threshold are solid, every pixel is with a threshold of 0.
+    class AlphaScan {
+        public:
+            enum class Kernel { SCALAR, SSE2, AVX2 };
+
+            static Kernel getKernel();
+            static bool setKernel(Kernel kernel); // False when the CPU lacks it, for benchmarks, not while scans run
+            static const char * getKernelName(Kernel kernel);
+
+            // One byte per row and per column of the rect, non zero when it holds a solid pixel
+            static void getOccupancy(const uint8_t * pixels, int stride, int x1, int y1, int x2, int y2,
+                                     std::vector<uint8_t> & rows, std::vector<uint8_t> & columns, uint8_t threshold = 1);
+
+            // Shrinks the rect to its solid pixels, false and unchanged when there are none
+            static bool getBounds(const uint8_t * pixels, int stride, int & x1, int & y1, int & x2, int & y2, uint8_t threshold = 1);
+
+            static bool isEmpty(const uint8_t * pixels, int stride, int x1, int y1, int x2, int y2, uint8_t threshold = 1);
+
+        private:
+            typedef bool (*RowKernel)(const uint8_t * row, int count, uint8_t * columns, uint8_t threshold);
+            static RowKernel rowKernel;
+            static Kernel kernel;
+
+            static bool supports(Kernel kernel);
+            static RowKernel select(Kernel kernel);
+    };
+
+}
+
+#endif
@@ -0,0 +1,325 @@
+#include "animated_sprite_renderer.h"
+
+using namespace uengine::graphics;
+using GraphicsBase = uengine::graphics::GraphicsBase;
+namespace gh = uengine::graphics::helper;
+
+AnimatedSpriteRenderer::AnimatedSpriteRenderer(GraphicsBase * gb_, VkRenderPass * renderPass_, SpriteAnimationTable * table_, uint32_t maxInstances_) {
+    gb = gb_;
+    renderPass = renderPass_;
+    table = table_;
+    maxInstances = maxInstances_;
+
+    pushConstants.vp = glm::mat4(1.0f);
+    pushConstants.time = 0.0f;
+    pushConstants.textureId = 0;
+
+    instances.reserve(maxInstances);
+
+    setupDescriptorPool();
+    setupBuffers();
+    setupDescriptorSetLayout();
+    setupDescriptorSets();
+    setupPipeline();
+}
+
+AnimatedSpriteRenderer::~AnimatedSpriteRenderer() {
+    for (auto & frame : frames) {
+        gb->unmapMemory(frame.memory);
+        gb->destroyBuffer(frame.buffer, nullptr);
+        gb->freeMemory(frame.memory, nullptr);
+    }
+    gb->destroyPipeline(pipeline, nullptr);
+    gb->destroyPipelineLayout(pipelineLayout, nullptr);
+    gb->destroyDescriptorSetLayout(instanceSetLayout, nullptr);
+    gb->destroyDescriptorPool(descriptorPool, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void AnimatedSpriteRenderer::setViewProjection(glm::mat4 vp) {
+    pushConstants.vp = vp;
+}
+
+void AnimatedSpriteRenderer::setTime(float time) {
+    pushConstants.time = time;
+}
+
+float AnimatedSpriteRenderer::getTime() {
+    return pushConstants.time;
+}
+
+uint32_t AnimatedSpriteRenderer::add(const AnimatedSpriteData & data) {
+    if (instances.size() >= maxInstances)
+        throw std::runtime_error("failed to add animated sprite, renderer is full!");
+
+    instances.push_back(data);
+    uint32_t index = instances.size() - 1;
+    markDirty(index, index + 1);
+    return index;
+}
+
+uint32_t AnimatedSpriteRenderer::add(SpriteBox * spriteBox) {
+    return add(makeInstance(spriteBox));
+}
+
+void AnimatedSpriteRenderer::set(uint32_t index, const AnimatedSpriteData & data) {
+    instances[index] = data;
+    markDirty(index, index + 1);
+}
+
+AnimatedSpriteData AnimatedSpriteRenderer::makeInstance(SpriteBox * spriteBox) {
+    if (spriteBox->getSprite() != table->getSprite())
+        throw std::runtime_error("failed to make animated sprite, sprite box uses another sprite!");
+
+    int animation = table->getAnimationIndex(spriteBox->getAnimation());
+    if (animation < 0)
+        throw std::runtime_error("failed to make animated sprite, animation has no frame!");
+
+    // Start in the past so the shader lands on the frame the box is currently showing
+    AnimatedSpriteData data = {};
+    data.position = glm::vec2(spriteBox->getPosition());
+    data.scale = glm::vec2(spriteBox->getSize());
+    data.animation = animation;
+    data.startTime = pushConstants.time - spriteBox->getAnimationTime();
+    data.tint = gh::packColor(glm::vec4(spriteBox->getTint(), 1.0f));
+    return data;
+}
+
+void AnimatedSpriteRenderer::clear() {
+    instances.clear();
+}
+
+uint32_t AnimatedSpriteRenderer::getInstanceCount() {
+    return instances.size();
+}
+
+size_t AnimatedSpriteRenderer::getUploadedBytes() {
+    return uploadedBytes;
+}
+
+void AnimatedSpriteRenderer::render(VkCommandBuffer cb) {
+    // The frame slot has been waited on, bring its copy of the instances up to date
+    FrameResources & frame = frames[gb->getCurrentFrame()];
+    uploadedBytes = 0;
+    if (frame.dirtyBegin < frame.dirtyEnd) {
+        uint32_t end = std::min<uint32_t>(frame.dirtyEnd, instances.size());
+        if (frame.dirtyBegin < end) {
+            uploadedBytes = (end - frame.dirtyBegin) * sizeof(AnimatedSpriteData);
+            memcpy(frame.instances + frame.dirtyBegin, instances.data() + frame.dirtyBegin, uploadedBytes);
+        }
+        frame.dirtyBegin = frame.dirtyEnd = 0;
+    }
+
+    if (instances.empty())
+        return;
+
+    pushConstants.textureId = table->getSprite()->getTextureId();
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdPushConstants(cb, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pushConstants);
+
+    std::array<VkDescriptorSet, 3> sets = {frame.descriptorSet, gb->getTextureTable(), table->getDescriptorSet()};
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, sets.size(), sets.data(), 0, nullptr);
+
+    vkCmdDraw(cb, 6, static_cast<uint32_t>(instances.size()), 0, 0);
+}
+
+/*
+ *  Internal methods
+ */
+
+void AnimatedSpriteRenderer::markDirty(uint32_t begin, uint32_t end) {
+    // Every slot keeps its own copy, each one has to catch up once
+    for (auto & frame : frames) {
+        if (frame.dirtyBegin == frame.dirtyEnd) {
+            frame.dirtyBegin = begin;
+            frame.dirtyEnd = end;
+        } else {
+            frame.dirtyBegin = std::min(frame.dirtyBegin, begin);
+            frame.dirtyEnd = std::max(frame.dirtyEnd, end);
+        }
+    }
+}
+
+
+/*----------------- Descriptors ----------------*/
+
+void AnimatedSpriteRenderer::setupDescriptorPool() {
+    uint32_t framesInFlight = gb->getFramesInFlight();
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight)
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo =
+        gh::descriptorPoolCreateInfo(
+            poolSizes.size(),
+            poolSizes.data(),
+            framesInFlight);
+
+    gb->createDescriptorPool(&descriptorPoolInfo, nullptr, &descriptorPool);
+}
+
+void AnimatedSpriteRenderer::setupBuffers() {
+    frames.resize(gb->getFramesInFlight());
+
+    for (auto & frame : frames) {
+        gb->createBuffer(
+            std::max<uint32_t>(maxInstances, 1) * sizeof(AnimatedSpriteData),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.buffer,
+            frame.memory);
+
+        void * data;
+        gb->mapMemory(frame.memory, 0, VK_WHOLE_SIZE, 0, &data);
+        frame.instances = (AnimatedSpriteData *) data;
+    }
+}
+
+void AnimatedSpriteRenderer::setupDescriptorSetLayout() {
+    // Set 0: instances of the frame, set 1 is the texture table and set 2 the animation table
+    VkDescriptorSetLayoutBinding instanceBinding =
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0);
+
+    VkDescriptorSetLayoutCreateInfo instanceLayoutInfo = gh::descriptorSetLayoutCreateInfo(&instanceBinding, 1);
+    gb->createDescriptorSetLayout(&instanceLayoutInfo, nullptr, &instanceSetLayout);
+}
+
+void AnimatedSpriteRenderer::setupDescriptorSets() {
+    for (auto & frame : frames) {
+        VkDescriptorSetAllocateInfo allocInfo =
+            gh::descriptorSetAllocateInfo(
+                descriptorPool,
+                &instanceSetLayout,
+                1);
+
+        gb->allocateDescriptorSets(&allocInfo, &frame.descriptorSet);
+
+        VkDescriptorBufferInfo bufferInfo =
+            gh::descriptorBufferInfo(
+                frame.buffer,
+                0,
+                VK_WHOLE_SIZE);
+
+        VkWriteDescriptorSet writeDescriptorSet =
+            gh::writeDescriptorSet(
+                frame.descriptorSet,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                0,
+                &bufferInfo);
+
+        gb->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+    }
+}
+
+
+/*---------------- Pipeline -----------------*/
+
+void AnimatedSpriteRenderer::setupPipeline() {
+    // Shaders
+    VkShaderModule vertShaderModule = gb->createShaderModule("res/shaders/animated_sprite/vert.spv");
+    // Fragment stage is shared with the sprite batch, the texture id is uniform for a whole draw
+    VkShaderModule fragShaderModule = gb->createShaderModule(gb->hasBindlessTextures()
+        ? "res/shaders/sprite_batch/frag_bindless.spv"
+        : "res/shaders/sprite_batch/frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+    shaderStages[0] = gh::pipelineShaderStageCreateInfo(vertShaderModule, VK_SHADER_STAGE_VERTEX_BIT);
+    shaderStages[1] = gh::pipelineShaderStageCreateInfo(fragShaderModule, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Vertex input, the unit quad is hardcoded in the shader
+    VkPipelineVertexInputStateCreateInfo vertexInputState = gh::pipelineVertexInputStateCreateInfo();
+    vertexInputState.vertexBindingDescriptionCount = 0;
+    vertexInputState.vertexAttributeDescriptionCount = 0;
+
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState =
+        gh::pipelineInputAssemblyStateCreateInfo(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            0,
+            VK_FALSE);
+
+    // Viewport
+    VkPipelineViewportStateCreateInfo viewportState = gh::pipelineViewportStateCreateInfo(1, 1, 0);
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizationState =
+        gh::pipelineRasterizationStateCreateInfo(
+            VK_POLYGON_MODE_FILL,
+            VK_CULL_MODE_NONE,
+            VK_FRONT_FACE_CLOCKWISE,
+            0);
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampleState =
+        gh::pipelineMultisampleStateCreateInfo(
+            VK_SAMPLE_COUNT_1_BIT,
+            0);
+
+    // Color blend attachment
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState =
+        gh::pipelineColorBlendAttachmentState(
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+            VK_TRUE);
+    colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_MAX;
+
+    // Color blend state
+    VkPipelineColorBlendStateCreateInfo colorBlendState =
+        gh::pipelineColorBlendStateCreateInfo(
+            1,
+            &colorBlendAttachmentState);
+
+    // Dynamic state
+    std::vector<VkDynamicState> dynamicStateEnables = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState =
+        gh::pipelineDynamicStateCreateInfo(
+            dynamicStateEnables.data(),
+            dynamicStateEnables.size(),
+            0);
+
+    // Pipeline layout creation, view projection, time and texture go through push constants
+    std::array<VkDescriptorSetLayout, 3> setLayouts = {instanceSetLayout, gb->getTextureTableLayout(), table->getDescriptorSetLayout()};
+    VkPushConstantRange pushConstantRange = gh::pushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, sizeof(PushConstants));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+        gh::pipelineLayoutCreateInfo(
+            setLayouts.data(),
+            setLayouts.size());
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    gb->createPipelineLayout(&pipelineLayoutInfo, nullptr, &pipelineLayout);
+
+    // Actual pipeline creation
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = gh::pipelineCreateInfo(pipelineLayout, *renderPass, 0);
+    pipelineCreateInfo.pVertexInputState = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState = &multisampleState;
+    pipelineCreateInfo.pViewportState = &viewportState;
+    pipelineCreateInfo.pDynamicState = &dynamicState;
+    pipelineCreateInfo.stageCount = shaderStages.size();
+    pipelineCreateInfo.pStages = shaderStages.data();
+
+    gb->createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+
+    // Cleanup
+    gb->destroyShaderModule(vertShaderModule, nullptr);
+    gb->destroyShaderModule(fragShaderModule, nullptr);
+}
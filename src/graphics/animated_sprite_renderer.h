@@ -0,0 +1,92 @@
+#ifndef ANIMATED_SPRITE_RENDERER_H
+#define ANIMATED_SPRITE_RENDERER_H
+
+#include <array>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "sprite.h"
+#include "sprite_animation_table.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+
+namespace uengine::graphics {
+
+    struct AnimatedSpriteData {
+        alignas(8) glm::vec2 position;
+        alignas(8) glm::vec2 scale;
+        alignas(4) uint32_t animation; // Index in the animation table
+        alignas(4) float startTime;    // Renderer time at which the animation was on its first frame
+        alignas(4) uint32_t tint;      // RGBA8
+        alignas(4) uint32_t padding;
+    };
+
+    // Draws sprite boxes of a single sprite whose animation is evaluated in the vertex shader
+    // from a SpriteAnimationTable. Instances persist between frames, only the ones changed with
+    // set() are uploaded again, idle animated sprites cost nothing but the time push constant.
+    // Rotation and shear of sprite boxes are not supported.
+    class AnimatedSpriteRenderer {
+        public:
+            AnimatedSpriteRenderer(GraphicsBase * gb, VkRenderPass * renderPass, SpriteAnimationTable * table, uint32_t maxInstances);
+            ~AnimatedSpriteRenderer();
+
+            void setViewProjection(glm::mat4 vp);
+            void setTime(float time);
+            float getTime();
+
+            uint32_t add(const AnimatedSpriteData & data); // Returns the instance index
+            uint32_t add(SpriteBox * spriteBox);
+            void set(uint32_t index, const AnimatedSpriteData & data);
+            AnimatedSpriteData makeInstance(SpriteBox * spriteBox);
+            void clear();
+            uint32_t getInstanceCount();
+            size_t getUploadedBytes(); // Instance bytes written by the last render
+
+            void render(VkCommandBuffer cb);
+
+        private:
+            GraphicsBase * gb;
+            VkRenderPass * renderPass;
+            SpriteAnimationTable * table;
+
+            uint32_t maxInstances;
+            std::vector<AnimatedSpriteData> instances;
+            size_t uploadedBytes = 0;
+
+            struct PushConstants {
+                alignas(16) glm::mat4 vp;
+                alignas(4) float time;
+                alignas(4) int textureId;
+            } pushConstants;
+
+            struct FrameResources {
+                VkBuffer buffer;
+                VkDeviceMemory memory;
+                AnimatedSpriteData * instances; // Persistently mapped
+                VkDescriptorSet descriptorSet;
+                uint32_t dirtyBegin = 0;        // Instance range this slot's buffer is missing
+                uint32_t dirtyEnd = 0;
+            };
+            std::vector<FrameResources> frames;
+
+            VkDescriptorPool descriptorPool;
+            VkDescriptorSetLayout instanceSetLayout;
+            VkPipelineLayout pipelineLayout;
+            VkPipeline pipeline;
+
+            void markDirty(uint32_t begin, uint32_t end);
+
+            void setupDescriptorPool();
+            void setupBuffers();
+            void setupDescriptorSetLayout();
+            void setupDescriptorSets();
+            void setupPipeline();
+    };
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include "frame_pacer.h"
+
+using FramePacer = uengine::graphics::FramePacer;
+
+// Below this margin the OS scheduler is not trusted, the remaining time is spent spinning
+static const std::chrono::microseconds SPIN_MARGIN(1500);
+
+FramePacer::FramePacer() {
+    lastFrame = Clock::now();
+    deadline = lastFrame;
+}
+
+/*
+ *  External methods
+ */
+
+void FramePacer::setFpsLimit(float fps) {
+    fpsLimit = std::max(fps, 0.0f);
+    deadline = Clock::now();
+}
+
+float FramePacer::getFpsLimit() {
+    return fpsLimit;
+}
+
+void FramePacer::wait() {
+    if (fpsLimit > 0.0f) {
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fpsLimit));
+        deadline += period;
+
+        Clock::time_point now = Clock::now();
+        if (deadline < now - period) {
+            // Too far behind (long frame, breakpoint...), don't try to catch up
+            deadline = now;
+        } else {
+            if (deadline - now > SPIN_MARGIN)
+                std::this_thread::sleep_for(deadline - now - SPIN_MARGIN);
+            while (Clock::now() < deadline)
+                std::this_thread::yield();
+        }
+    }
+
+    Clock::time_point now = Clock::now();
+    frameTime = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    if (recording)
+        frameTimes.push_back(frameTime);
+}
+
+float FramePacer::getFrameTime() {
+    return frameTime;
+}
+
+void FramePacer::startRecording(size_t expectedFrames) {
+    frameTimes.clear();
+    frameTimes.reserve(expectedFrames);
+    recording = true;
+    lastFrame = Clock::now();
+}
+
+void FramePacer::stopRecording() {
+    recording = false;
+}
+
+const std::vector<float> & FramePacer::getRecordedFrameTimes() {
+    return frameTimes;
+}
+
+float FramePacer::percentile(float p) {
+    if (frameTimes.empty())
+        return 0.0f;
+
+    // Nearest rank on a sorted copy, recording keeps the original order
+    std::vector<float> sorted = frameTimes;
+    size_t rank = std::min(sorted.size() - 1, (size_t) (p / 100.0f * sorted.size()));
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
@@ -0,0 +1,41 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+namespace uengine::graphics {
+
+    class FramePacer {
+        public:
+            FramePacer();
+
+            void setFpsLimit(float fps); // 0 disables the limiter
+            float getFpsLimit();
+
+            // Called once per frame, blocks until the next deadline when limited and records the frame time
+            void wait();
+            float getFrameTime(); // Last frame time in milliseconds
+
+            void startRecording(size_t expectedFrames = 0);
+            void stopRecording();
+            const std::vector<float> & getRecordedFrameTimes();
+            float percentile(float p); // p in [0, 100], over recorded frame times
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            float fpsLimit = 0.0f;
+            Clock::time_point lastFrame;
+            Clock::time_point deadline;
+            float frameTime = 0.0f;
+
+            bool recording = false;
+            std::vector<float> frameTimes;
+    };
+
+}
+
+#endif
@@ -1,10 +1,12 @@
 #include "graphics_base.h"
+#include "graphics_helper.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 
 using namespace uengine::graphics;
+namespace gh = uengine::graphics::helper;
 
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
@@ -14,6 +16,13 @@ const bool enableValidationLayers = true;
 
 const int MAX_FRAMES_IN_FLIGHT = 2;
 
+// Texture table sizes, the fallback one is also hardcoded in the non-bindless shaders
+const uint32_t MAX_TEXTURE_TABLE_SIZE = 4096;
+const uint32_t FALLBACK_TEXTURE_TABLE_SIZE = 16;
+
+// Dynamic memory per frame slot
+const VkDeviceSize DYNAMIC_BUFFER_SIZE = 4 << 20;
+
 const std::vector<const char*> validationLayers = {
     "VK_LAYER_KHRONOS_validation"
 };
@@ -45,9 +54,11 @@ static void checkVkResult(VkResult err)
         abort();
 }
 
-GraphicsBase::GraphicsBase(int width, int height) {
-    initWindow_(width, height);
-    initVulkan_();
+GraphicsBase::GraphicsBase(int width, int height, bool headless_) {
+    headless = headless_;
+    if (!headless)
+        initWindow_(width, height);
+    initVulkan_(width, height);
     initImgui_();
 }
 
@@ -67,28 +78,250 @@ GraphicsBase::~GraphicsBase() {
 
 
 bool GraphicsBase::shouldClose() {
-    glfwWindowShouldClose(window);
+    if (headless)
+        return false;
+    return glfwWindowShouldClose(window);
 }
 
 void GraphicsBase::poolEvents() {
-    glfwPollEvents();
+    frameInputTimes[currentFrame] = std::chrono::steady_clock::now();
+    if (!headless)
+        glfwPollEvents();
 }
 
 void GraphicsBase::draw() {
-    if (!acquire_()) {
+    // A frame dropped on an out of date swapchain is still paced and recorded, its time
+    // would otherwise be added to the next one
+    if (acquire_()) {
+        render_();
+        present_();
+    }
+    framePacer.wait();
+}
+
+void GraphicsBase::waitFrame() {
+    if (frameWaited)
         return;
+
+    // In low latency mode the previous frame has to be done too, nothing is left queued
+    // behind the input about to be sampled
+    size_t lastFrame = currentFrame;
+    if (lowLatency) {
+        vkWaitForFences(device, static_cast<uint32_t>(inFlightFences.size()), inFlightFences.data(), VK_TRUE, UINT64_MAX);
+        lastFrame = (currentFrame + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT;
+        completedFrames = submittedFrames;
+    } else {
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        completedFrames = std::max(completedFrames, frameSubmissions[currentFrame]);
+    }
+
+    // The fence is only observed now, so this is an upper bound when the GPU finished early
+    if (frameSubmissions[lastFrame] > measuredFrames) {
+        measuredFrames = frameSubmissions[lastFrame];
+        float latency = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameInputTimes[lastFrame]).count();
+        latencyEstimate = latencyEstimate == 0.0f ? latency : 0.9f * latencyEstimate + 0.1f * latency;
     }
-    render_();
-    present_();
+
+    // Nothing pending reads the region of this slot anymore
+    dynamicHead = 0;
+
+    flushDeletionQueue_();
+    frameWaited = true;
+}
+
+size_t GraphicsBase::getCurrentFrame() {
+    return currentFrame;
+}
+
+size_t GraphicsBase::getFramesInFlight() {
+    return MAX_FRAMES_IN_FLIGHT;
+}
+
+void GraphicsBase::setLowLatency(bool state) {
+    lowLatency = state;
+}
+
+bool GraphicsBase::isLowLatency() {
+    return lowLatency;
+}
+
+float GraphicsBase::getLatencyEstimate() {
+    return latencyEstimate;
 }
 
 void GraphicsBase::addDrawable(Drawable * drawable) {
     drawables.push_back(drawable);
+    VkExtent2D extent = getExtent();
+    drawable->resize(extent.width, extent.height);
+}
+
+VkDevice * GraphicsBase::getDevice() {
+    return &device;
+}
+
+bool GraphicsBase::isHeadless() {
+    return headless;
+}
+
+VkExtent2D GraphicsBase::getExtent() {
+    if (headless)
+        return swapChainExtent;
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
-    drawable->resize(width, height);
+    return {(uint32_t) width, (uint32_t) height};
+}
+
+void GraphicsBase::readPixels(std::vector<uint8_t> & pixels) {
+    if (!headless)
+        throw std::runtime_error("read-back is only available in headless mode!");
+
+    // Make sure every submitted frame is done with the target
+    vkWaitForFences(device, static_cast<uint32_t>(inFlightFences.size()), inFlightFences.data(), VK_TRUE, UINT64_MAX);
+
+    VkDeviceSize size = swapChainExtent.width * swapChainExtent.height * 4;
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands_();
+
+    // Color writes of the last frame must be visible to the transfer
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapChainImages[0];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region = {};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {swapChainExtent.width, swapChainExtent.height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, swapChainImages[0], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, 1, &region);
+
+    VkBufferMemoryBarrier bufferBarrier = {};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = stagingBuffer;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+    endSingleTimeCommands_(commandBuffer);
+
+    void * data;
+    vkMapMemory(device, stagingBufferMemory, 0, size, 0, &data);
+    pixels.resize(size);
+    memcpy(pixels.data(), data, static_cast<size_t>(size));
+    vkUnmapMemory(device, stagingBufferMemory);
+
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
+}
+
+
+void GraphicsBase::setPresentMode(VkPresentModeKHR mode) {
+    if (mode == requestedPresentMode)
+        return;
+    requestedPresentMode = mode;
+    presentModeChanged = !headless;
+}
+
+VkPresentModeKHR GraphicsBase::getPresentMode() {
+    return swapChainPresentMode;
+}
+
+bool GraphicsBase::isPresentModeSupported(VkPresentModeKHR mode) {
+    if (headless)
+        return mode == VK_PRESENT_MODE_FIFO_KHR;
+    std::vector<VkPresentModeKHR> presentModes = querySwapChainSupport_(physicalDevice).presentModes;
+    return std::find(presentModes.begin(), presentModes.end(), mode) != presentModes.end();
+}
+
+FramePacer * GraphicsBase::getFramePacer() {
+    return &framePacer;
+}
+
+void GraphicsBase::deferDestruction(std::function<void()> destroyer) {
+    // The frame being recorded is the last one that may reference the object
+    deletionQueue.emplace_back(submittedFrames + 1, std::move(destroyer));
+}
+
+void GraphicsBase::removeTexture(ImTextureID texture) {
+    deferDestruction([=]() { ImGui_ImplVulkan_RemoveTexture(texture); });
+}
+
+uint32_t GraphicsBase::registerTexture(VkImageView imageView, VkSampler sampler) {
+    if (freeTextureIds.empty())
+        throw std::runtime_error("failed to register texture, texture table is full!");
+
+    uint32_t textureId = freeTextureIds.back();
+    freeTextureIds.pop_back();
+
+    textureTable[textureId] = {sampler, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    for (auto & dirty : dirtyTextureIds)
+        dirty.push_back(textureId);
+
+    return textureId;
+}
+
+void GraphicsBase::unregisterTexture(uint32_t textureId) {
+    if (textureId == 0 || textureId >= textureTableSize)
+        return;
+
+    // Point the entry back to the default texture, the index is reused once pending frames are done
+    textureTable[textureId] = textureTable[0];
+    for (auto & dirty : dirtyTextureIds)
+        dirty.push_back(textureId);
+    deferDestruction([=]() { freeTextureIds.push_back(textureId); });
+}
+
+VkDescriptorSetLayout GraphicsBase::getTextureTableLayout() {
+    return textureTableLayout;
+}
+
+VkDescriptorSet GraphicsBase::getTextureTable() {
+    return textureTableSets[currentFrame];
+}
+
+uint32_t GraphicsBase::getTextureTableSize() {
+    return textureTableSize;
+}
+
+bool GraphicsBase::hasBindlessTextures() {
+    return bindlessTextures;
+}
+
+uint32_t GraphicsBase::allocateDynamic(VkDeviceSize size, void ** data) {
+    VkDeviceSize offset = (dynamicHead + dynamicAlignment - 1) / dynamicAlignment * dynamicAlignment;
+    if (offset + size > DYNAMIC_BUFFER_SIZE)
+        throw std::runtime_error("failed to allocate dynamic memory, frame region is full!");
+
+    dynamicHead = offset + size;
+    offset += currentFrame * DYNAMIC_BUFFER_SIZE;
+    *data = dynamicData + offset;
+    return static_cast<uint32_t>(offset);
+}
+
+uint32_t GraphicsBase::uploadDynamic(const void * data, VkDeviceSize size) {
+    void * dst;
+    uint32_t offset = allocateDynamic(size, &dst);
+    memcpy(dst, data, size);
+    return offset;
 }
 
+VkBuffer GraphicsBase::getDynamicBuffer() {
+    return dynamicBuffer;
+}
 
 void GraphicsBase::createTextureImage(std::string filename, VkImage * textureImage, VkDeviceMemory * textureImageMemory, VkImageView * textureImageView, VkSampler * textureSampler, uint8_t ** dataPtr, int * w, int * h, bool keepData) {
     int texWidth, texHeight, texChannels;
@@ -131,15 +364,152 @@ void GraphicsBase::createTextureImage(std::string filename, VkImage * textureIma
 }
 
 void GraphicsBase::deleteTextureImage(VkImage * textureImage, VkDeviceMemory * textureImageMemory, VkImageView * textureImageView, VkSampler * textureSampler, uint8_t * data) {
-    vkDestroySampler(device, *textureSampler, nullptr);
-    vkDestroyImageView(device, *textureImageView, nullptr);
-    vkDestroyImage(device, *textureImage, nullptr);
-    vkFreeMemory(device, *textureImageMemory, nullptr);
+    destroySampler(*textureSampler, nullptr);
+    destroyImageView(*textureImageView, nullptr);
+    destroyImage(*textureImage, nullptr);
+    freeMemory(*textureImageMemory, nullptr);
     if (data) {
         stbi_image_free(data);
     }
 }
 
+void GraphicsBase::createOffscreenRenderPass(VkFormat format, VkRenderPass * renderPass) {
+    VkAttachmentDescription attachmentDescription = {};
+    attachmentDescription.format = format;
+    attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachmentDescription.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    
+    VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    
+    VkSubpassDescription subpassDescription = {};
+    subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpassDescription.colorAttachmentCount = 1;
+    subpassDescription.pColorAttachments = &colorReference;
+    subpassDescription.pDepthStencilAttachment = nullptr;
+    
+    // Previous reads of the image finish before the pass writes it, its writes finish before later reads
+    std::array<VkSubpassDependency, 2> dependencies;
+
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo = {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &attachmentDescription;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpassDescription;
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies = dependencies.data();
+
+    createRenderPass(&renderPassInfo, nullptr, renderPass);
+}
+
+void GraphicsBase::createOffscreenTarget(VkRenderPass renderPass, VkFormat format, int32_t width, int32_t height, OffscreenTarget * target, bool sampler) {
+    target->width = width;
+    target->height = height;
+
+    // Image creation
+    VkImageCreateInfo image = gh::imageCreateInfo();
+    image.imageType = VK_IMAGE_TYPE_2D;
+    image.format = format;
+    image.extent.width = width;
+    image.extent.height = height;
+    image.extent.depth = 1;
+    image.mipLevels = 1;
+    image.arrayLayers = 1;
+    image.samples = VK_SAMPLE_COUNT_1_BIT;
+    image.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    createImage(&image, nullptr, &target->image);
+
+    // Image memory allocation
+    VkMemoryAllocateInfo memAlloc = gh::memoryAllocateInfo();
+    VkMemoryRequirements memReqs;
+    getImageMemoryRequirements(target->image, &memReqs);
+    memAlloc.allocationSize = memReqs.size;
+    memAlloc.memoryTypeIndex = findMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    allocateMemory(&memAlloc, nullptr, &target->mem);
+    
+    bindImageMemory(target->image, target->mem, 0);
+
+    // Image view creation
+    VkImageViewCreateInfo colorImageView = gh::imageViewCreateInfo();
+    colorImageView.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    colorImageView.format = format;
+    colorImageView.subresourceRange = {};
+    colorImageView.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    colorImageView.subresourceRange.baseMipLevel = 0;
+    colorImageView.subresourceRange.levelCount = 1;
+    colorImageView.subresourceRange.baseArrayLayer = 0;
+    colorImageView.subresourceRange.layerCount = 1;
+    colorImageView.image = target->image;
+
+    createImageView(&colorImageView, nullptr, &target->view);
+
+    // Sampler creation
+    target->sampler = VK_NULL_HANDLE;
+    if (sampler) {
+        VkSamplerCreateInfo samplerInfo = gh::samplerCreateInfo();
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = samplerInfo.addressModeU;
+        samplerInfo.addressModeW = samplerInfo.addressModeU;
+        samplerInfo.mipLodBias = 0.0f;
+        samplerInfo.maxAnisotropy = 1.0f;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = 1.0f;
+        samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+
+        createSampler(&samplerInfo, nullptr, &target->sampler);
+    }
+
+    // Framebuffer creation
+    VkFramebufferCreateInfo frameBufferCreateInfo = gh::frameBufferCreateInfo();
+    frameBufferCreateInfo.renderPass = renderPass;
+    frameBufferCreateInfo.attachmentCount = 1;
+    frameBufferCreateInfo.pAttachments = &target->view;
+    frameBufferCreateInfo.width = width;
+    frameBufferCreateInfo.height = height;
+    frameBufferCreateInfo.layers = 1;
+
+    createFramebuffer(&frameBufferCreateInfo, nullptr, &target->frameBuffer);
+}
+
+void GraphicsBase::destroyOffscreenTarget(OffscreenTarget * target) {
+    destroyFramebuffer(target->frameBuffer, nullptr);
+    if (target->sampler != VK_NULL_HANDLE)
+        destroySampler(target->sampler, nullptr);
+    destroyImageView(target->view, nullptr);
+    destroyImage(target->image, nullptr);
+    freeMemory(target->mem, nullptr);
+    target->sampler = VK_NULL_HANDLE;
+    target->width = 0;
+    target->height = 0;
+}
+
 uint32_t GraphicsBase::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
     VkPhysicalDeviceMemoryProperties memProperties;
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
@@ -160,7 +530,7 @@ void GraphicsBase::createRenderPass(const VkRenderPassCreateInfo * info, const V
 }
 
 void GraphicsBase::destroyRenderPass(VkRenderPass renderPass, const VkAllocationCallbacks * callback) {
-    vkDestroyRenderPass(device, renderPass, callback);
+    deferDestruction([=]() { vkDestroyRenderPass(device, renderPass, callback); });
 }
 
 void GraphicsBase::createDescriptorPool(const VkDescriptorPoolCreateInfo * info, const VkAllocationCallbacks * callback, VkDescriptorPool * pool) {
@@ -170,7 +540,7 @@ void GraphicsBase::createDescriptorPool(const VkDescriptorPoolCreateInfo * info,
 }
 
 void GraphicsBase::destroyDescriptorPool(VkDescriptorPool pool, const VkAllocationCallbacks * callback) {
-    vkDestroyDescriptorPool(device, pool, callback);
+    deferDestruction([=]() { vkDestroyDescriptorPool(device, pool, callback); });
 }
 
 void GraphicsBase::createDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo * info, const VkAllocationCallbacks * callback, VkDescriptorSetLayout * setLayout) {
@@ -180,7 +550,7 @@ void GraphicsBase::createDescriptorSetLayout(const VkDescriptorSetLayoutCreateIn
 }
 
 void GraphicsBase::destroyDescriptorSetLayout(VkDescriptorSetLayout layout, const VkAllocationCallbacks * callback) {
-    vkDestroyDescriptorSetLayout(device, layout, callback);
+    deferDestruction([=]() { vkDestroyDescriptorSetLayout(device, layout, callback); });
 }
 
 void GraphicsBase::allocateDescriptorSets(const VkDescriptorSetAllocateInfo * info, VkDescriptorSet * set) {
@@ -200,7 +570,7 @@ void GraphicsBase::createPipelineLayout(const VkPipelineLayoutCreateInfo * info,
 }
 
 void GraphicsBase::destroyPipelineLayout(VkPipelineLayout layout, const VkAllocationCallbacks * callback) {
-    vkDestroyPipelineLayout(device, layout, callback);
+    deferDestruction([=]() { vkDestroyPipelineLayout(device, layout, callback); });
 }
 
 void GraphicsBase::createGraphicsPipelines(VkPipelineCache cache, uint32_t count, const VkGraphicsPipelineCreateInfo * info, const VkAllocationCallbacks * callback, VkPipeline * pipeline) {
@@ -210,7 +580,7 @@ void GraphicsBase::createGraphicsPipelines(VkPipelineCache cache, uint32_t count
 }
 
 void GraphicsBase::destroyPipeline(VkPipeline pipeline, const VkAllocationCallbacks * callback) {
-    vkDestroyPipeline(device, pipeline, callback);
+    deferDestruction([=]() { vkDestroyPipeline(device, pipeline, callback); });
 }
 
 void GraphicsBase::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
@@ -240,7 +610,7 @@ void GraphicsBase::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkM
 }
 
 void GraphicsBase::destroyBuffer(VkBuffer buffer, const VkAllocationCallbacks * callback) {
-    vkDestroyBuffer(device, buffer, callback);
+    deferDestruction([=]() { vkDestroyBuffer(device, buffer, callback); });
 }
 
 void GraphicsBase::mapMemory(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void ** data) {
@@ -302,7 +672,7 @@ void GraphicsBase::allocateMemory(const VkMemoryAllocateInfo * info,  const VkAl
 }
 
 void GraphicsBase::freeMemory(VkDeviceMemory memory, const VkAllocationCallbacks * callback) {
-    vkFreeMemory(device, memory, callback);
+    deferDestruction([=]() { vkFreeMemory(device, memory, callback); });
 }
 
 void GraphicsBase::bindImageMemory(VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset) {
@@ -318,7 +688,7 @@ void GraphicsBase::createImage(const VkImageCreateInfo * info, const VkAllocatio
 }
 
 void GraphicsBase::destroyImage(VkImage image, const VkAllocationCallbacks * callback) {
-    vkDestroyImage(device, image, callback);
+    deferDestruction([=]() { vkDestroyImage(device, image, callback); });
 }
 
 void GraphicsBase::createImageView(const VkImageViewCreateInfo * info, const VkAllocationCallbacks * callback, VkImageView * imageView) {
@@ -328,7 +698,7 @@ void GraphicsBase::createImageView(const VkImageViewCreateInfo * info, const VkA
 }
 
 void GraphicsBase::destroyImageView(VkImageView imageView, const VkAllocationCallbacks * callback) {
-    vkDestroyImageView(device, imageView, callback);
+    deferDestruction([=]() { vkDestroyImageView(device, imageView, callback); });
 }
 
 void GraphicsBase::createSampler(const VkSamplerCreateInfo * info, const VkAllocationCallbacks * callback, VkSampler * sampler) {
@@ -338,7 +708,7 @@ void GraphicsBase::createSampler(const VkSamplerCreateInfo * info, const VkAlloc
 }
 
 void GraphicsBase::destroySampler(VkSampler sampler, const VkAllocationCallbacks * callback) {
-    vkDestroySampler(device, sampler, callback);
+    deferDestruction([=]() { vkDestroySampler(device, sampler, callback); });
 }
 
 void GraphicsBase::createFramebuffer(const VkFramebufferCreateInfo * info, const VkAllocationCallbacks * callback, VkFramebuffer * framebuffer) {
@@ -348,7 +718,7 @@ void GraphicsBase::createFramebuffer(const VkFramebufferCreateInfo * info, const
 }
 
 void GraphicsBase::destroyFramebuffer(VkFramebuffer framebuffer, const VkAllocationCallbacks * callback) {
-    vkDestroyFramebuffer(device, framebuffer, callback);
+    deferDestruction([=]() { vkDestroyFramebuffer(device, framebuffer, callback); });
 }
 
 
@@ -376,13 +746,17 @@ void GraphicsBase::initWindow_(int width, int height) {
     glfwSetFramebufferSizeCallback(window, framebufferResizeCallback_);
 }
 
-void GraphicsBase::initVulkan_() {
+void GraphicsBase::initVulkan_(int width, int height) {
     createInstance_();
     setupDebugMessenger_();
-    createSurface_();
+    if (!headless)
+        createSurface_();
     pickPhysicalDevice_();
     createLogicalDevice_();
-    createSwapChain_();
+    if (headless)
+        createHeadlessTarget_(width, height);
+    else
+        createSwapChain_();
     createImageViews_();
     createRenderPass_();
     createFramebuffers_();
@@ -390,6 +764,13 @@ void GraphicsBase::initVulkan_() {
     createCommandPool_();
     createCommandBuffers_();
     createSyncObjects_();
+    createDefaultTexture_();
+    createTextureTable_();
+    createDynamicBuffer_();
+
+    // Read-back is valid even before the first frame
+    if (headless)
+        transitionImageLayout_(&swapChainImages[0], swapChainImageFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 }
 
 void GraphicsBase::initImgui_() {
@@ -401,7 +782,8 @@ void GraphicsBase::initImgui_() {
     //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
     // Setup Platform/Renderer bindings
     
-    ImGui_ImplGlfw_InitForVulkan(window, true);
+    if (!headless)
+        ImGui_ImplGlfw_InitForVulkan(window, true);
     ImGui_ImplVulkan_InitInfo init_info = {};
     init_info.Instance = instance;
     init_info.PhysicalDevice = physicalDevice;
@@ -437,7 +819,17 @@ void GraphicsBase::initImgui_() {
 }
 
 bool GraphicsBase::acquire_() {
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    // Callers that did not schedule the wait themselves get it here
+    waitFrame();
+
+    if (headless) {
+        // Single offscreen target, nothing to acquire
+        imageIndex = 0;
+        if (imagesInFlight[imageIndex] != VK_NULL_HANDLE)
+            vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+        return true;
+    }
 
     VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
@@ -457,44 +849,57 @@ bool GraphicsBase::acquire_() {
 
 void GraphicsBase::render_() {
     ImGui_ImplVulkan_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    if (headless) {
+        // No platform backend, feed display size and timing ourselves
+        ImGuiIO& io = ImGui::GetIO();
+        auto time = std::chrono::high_resolution_clock::now();
+        io.DisplaySize = ImVec2((float) swapChainExtent.width, (float) swapChainExtent.height);
+        io.DeltaTime = std::max(((std::chrono::duration<float>) (time - lastFrameTime)).count(), 1e-6f);
+        lastFrameTime = time;
+    } else {
+        ImGui_ImplGlfw_NewFrame();
+    }
     ImGui::NewFrame();
     for (auto drawable: drawables)
         drawable->renderUI();   
     ImGui::Render();
-    for (size_t i = 0; i < commandBuffers.size(); i++) {
-        vkResetCommandBuffer(commandBuffers[i], VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
 
-        VkCommandBufferBeginInfo beginInfo = {};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    // The fence of this frame slot has been waited on, its command buffer is free
+    VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    vkResetCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
 
-        if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS)
-            throw std::runtime_error("failed to begin recording command buffer!");
-        
-        // Render UI and related drawing data
-        for (auto drawable: drawables)
-            drawable->render(commandBuffers[i]);   
-
-        // Clear screen
-        VkRenderPassBeginInfo renderPassInfo = {};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = renderPass;
-        renderPassInfo.framebuffer = swapChainFramebuffers[i];
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = swapChainExtent;
-
-        VkClearValue clearColor = {1.0f, 0.0f, 0.0f, 0.0f};
-        renderPassInfo.clearValueCount = 1;
-        renderPassInfo.pClearValues = &clearColor;
-
-        vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-            // Draw everything
-            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffers[i]);
-        vkCmdEndRenderPass(commandBuffers[i]);
-        
-        if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS)
-            throw std::runtime_error("failed to record command buffer!");
-    }
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording command buffer!");
+    
+    // Drawables may sample any registered texture
+    updateTextureTable_();
+
+    // Render UI and related drawing data
+    for (auto drawable: drawables)
+        drawable->render(commandBuffer);   
+
+    // Clear screen
+    VkRenderPassBeginInfo renderPassInfo = {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = renderPass;
+    renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = swapChainExtent;
+
+    VkClearValue clearColor = {1.0f, 0.0f, 0.0f, 0.0f};
+    renderPassInfo.clearValueCount = 1;
+    renderPassInfo.pClearValues = &clearColor;
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        // Draw everything
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+    vkCmdEndRenderPass(commandBuffer);
+    
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record command buffer!");
 }
 
 void GraphicsBase::present_() {
@@ -503,20 +908,27 @@ void GraphicsBase::present_() {
 
     VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headless ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
+    submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
     
     VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
     if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
         throw std::runtime_error("failed to submit draw command buffer!");
+    frameSubmissions[currentFrame] = ++submittedFrames;
+
+    if (headless) {
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        frameWaited = false;
+        return;
+    }
 
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -529,16 +941,47 @@ void GraphicsBase::present_() {
 
     VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized || presentModeChanged) {
         framebufferResized = false;
+        presentModeChanged = false;
         recreateSwapChain_();
     } else if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to present swap chain image!");
     }
 
-    vkQueueWaitIdle(presentQueue);
-
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    frameWaited = false;
+}
+
+void GraphicsBase::flushDeletionQueue_(bool all) {
+    // Tags only grow, stop at the first object whose frame is still pending
+    while (!deletionQueue.empty() && (all || deletionQueue.front().first <= completedFrames)) {
+        std::function<void()> destroyer = std::move(deletionQueue.front().second);
+        deletionQueue.pop_front();
+        destroyer();
+    }
+}
+
+void GraphicsBase::updateTextureTable_() {
+    // The set of this slot is not used by any pending frame, it can be written directly
+    std::vector<uint32_t> & dirty = dirtyTextureIds[currentFrame];
+    if (dirty.empty())
+        return;
+
+    std::vector<VkWriteDescriptorSet> writes(dirty.size());
+    for (size_t i = 0; i < dirty.size(); i++) {
+        writes[i] = {};
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = textureTableSets[currentFrame];
+        writes[i].dstBinding = 0;
+        writes[i].dstArrayElement = dirty[i];
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].pImageInfo = &textureTable[dirty[i]];
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    dirty.clear();
 }
 
 void GraphicsBase::createImage_(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage * image, VkDeviceMemory * imageMemory) {
@@ -584,8 +1027,8 @@ void GraphicsBase::createTextureSampler_(VkSampler * textureSampler) {
     samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
-    samplerInfo.maxAnisotropy = 16;
+    samplerInfo.anisotropyEnable = samplerAnisotropy ? VK_TRUE : VK_FALSE;
+    samplerInfo.maxAnisotropy = samplerAnisotropy ? 16 : 1;
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.compareEnable = VK_FALSE;
@@ -645,6 +1088,12 @@ void GraphicsBase::transitionImageLayout_(VkImage * image, VkFormat format, VkIm
 
         sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
         destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    } else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     } else {
         throw std::invalid_argument("unsupported layout transition!");
     }
@@ -722,6 +1171,8 @@ void GraphicsBase::createSyncObjects_() {
     renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
     imagesInFlight.resize(swapChainImages.size(), VK_NULL_HANDLE);
+    frameSubmissions.resize(MAX_FRAMES_IN_FLIGHT, 0);
+    frameInputTimes.resize(MAX_FRAMES_IN_FLIGHT, std::chrono::steady_clock::now());
 
     VkSemaphoreCreateInfo semaphoreInfo = {};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -750,7 +1201,8 @@ void GraphicsBase::createCommandPool_() {
 }
 
 void GraphicsBase::createCommandBuffers_() {
-    commandBuffers.resize(swapChainFramebuffers.size());
+    // One per frame in flight, independent from the swapchain image count
+    commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -771,7 +1223,8 @@ void GraphicsBase::createRenderPass_() {
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // The headless target is read back instead of presented
+    colorAttachment.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
@@ -875,6 +1328,109 @@ void GraphicsBase::createDescriptorPool_() {
     vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool);
 }
 
+void GraphicsBase::createDefaultTexture_() {
+    // Single white texel, bound to every unused entry of the texture table
+    const uint8_t white[4] = {255, 255, 255, 255};
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    createBuffer(sizeof(white), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, sizeof(white), 0, &data);
+    memcpy(data, white, sizeof(white));
+    vkUnmapMemory(device, stagingBufferMemory);
+
+    createImage_(1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &defaultTextureImage, &defaultTextureMemory);
+
+    transitionImageLayout_(&defaultTextureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    copyBufferToImage_(&stagingBuffer, &defaultTextureImage, 1, 1);
+    transitionImageLayout_(&defaultTextureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+    createImageView_(&defaultTextureImage, VK_FORMAT_R8G8B8A8_UNORM, &defaultTextureView);
+    createTextureSampler_(&defaultTextureSampler);
+}
+
+void GraphicsBase::createTextureTable_() {
+    // Without descriptor indexing every entry is statically used and must stay valid
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = textureTableSize;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorBindingFlagsEXT bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = bindlessTextures ? &bindingFlagsInfo : nullptr;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &textureTableLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create texture table layout!");
+
+    VkDescriptorPoolSize poolSize = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureTableSize * MAX_FRAMES_IN_FLIGHT};
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &textureTablePool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create texture table pool!");
+
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, textureTableLayout);
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = textureTablePool;
+    allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+    allocInfo.pSetLayouts = layouts.data();
+
+    textureTableSets.resize(MAX_FRAMES_IN_FLIGHT);
+    if (vkAllocateDescriptorSets(device, &allocInfo, textureTableSets.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate texture table!");
+
+    // Every entry starts as the default texture, lowest indices are handed out first
+    textureTable.assign(textureTableSize, {defaultTextureSampler, defaultTextureView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+    freeTextureIds.clear();
+    for (uint32_t i = textureTableSize - 1; i > 0; i--)
+        freeTextureIds.push_back(i);
+
+    for (auto set : textureTableSets) {
+        VkWriteDescriptorSet write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = 0;
+        write.dstArrayElement = 0;
+        write.descriptorCount = textureTableSize;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = textureTable.data();
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    }
+
+    dirtyTextureIds.assign(MAX_FRAMES_IN_FLIGHT, {});
+}
+
+void GraphicsBase::createDynamicBuffer_() {
+    createBuffer(
+        DYNAMIC_BUFFER_SIZE * MAX_FRAMES_IN_FLIGHT,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        dynamicBuffer,
+        dynamicMemory);
+
+    // Mapped for the whole lifetime of the device
+    mapMemory(dynamicMemory, 0, VK_WHOLE_SIZE, 0, (void **) &dynamicData);
+}
+
 void GraphicsBase::createInstance_() {
     // If the wanted validation layers aren't available, terminate
     if (enableValidationLayers && !checkValidationLayerSupport_())
@@ -887,7 +1443,8 @@ void GraphicsBase::createInstance_() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // 1.1 for vkGetPhysicalDeviceFeatures2 and maintenance3, needed by descriptor indexing
+    appInfo.apiVersion = VK_API_VERSION_1_1;
 
     // Instance info
     VkInstanceCreateInfo createInfo = {};
@@ -920,11 +1477,15 @@ void GraphicsBase::createInstance_() {
 }
 
 std::vector<const char*> GraphicsBase::getRequiredExtensions_() {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    std::vector<const char*> extensions;
+
+    // Surface extensions are only needed when presenting to a window
+    if (!headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers)
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -967,16 +1528,14 @@ bool GraphicsBase::isDeviceSuitable_(VkPhysicalDevice device) {
     // Check if extension support is available
     bool extensionsSupported = checkDeviceExtensionSupport_(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    bool swapChainAdequate = headless;
+    if (extensionsSupported && !headless) {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport_(device);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
 
-    VkPhysicalDeviceFeatures supportedFeatures;
-    vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
-
-    return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+    // Software implementations (lavapipe) don't always expose anisotropy, it's enabled when available
+    return indices.isComplete() && extensionsSupported && swapChainAdequate;
 }
 
 QueueFamilyIndices GraphicsBase::findQueueFamilies_(VkPhysicalDevice device) {
@@ -993,13 +1552,18 @@ QueueFamilyIndices GraphicsBase::findQueueFamilies_(VkPhysicalDevice device) {
     int i = 0;
     for (const auto& queueFamily : queueFamilies) {
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (!headless)
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
         
         if (presentSupport)
             indices.presentFamily = i;
 
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
             indices.graphicsFamily = i;
+            // Without a surface, "presenting" is a submission on the graphics queue
+            if (headless)
+                indices.presentFamily = i;
+        }
 
         // If a presentation and graphics queues are available, exit
         if (indices.isComplete())
@@ -1020,7 +1584,8 @@ bool GraphicsBase::checkDeviceExtensionSupport_(VkPhysicalDevice device) {
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+    std::vector<const char*> wantedExtensions = getRequiredDeviceExtensions_();
+    std::set<std::string> requiredExtensions(wantedExtensions.begin(), wantedExtensions.end());
 
     // Check if the available extension cover the wanted device extensions
     for (const auto& extension : availableExtensions) {
@@ -1030,6 +1595,26 @@ bool GraphicsBase::checkDeviceExtensionSupport_(VkPhysicalDevice device) {
     return requiredExtensions.empty();
 }
 
+bool GraphicsBase::isDeviceExtensionSupported_(VkPhysicalDevice device, const char * extension) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& available : availableExtensions) {
+        if (strcmp(available.extensionName, extension) == 0)
+            return true;
+    }
+    return false;
+}
+
+std::vector<const char*> GraphicsBase::getRequiredDeviceExtensions_() {
+    if (headless)
+        return {};
+    return deviceExtensions;
+}
+
 void GraphicsBase::createLogicalDevice_() {
     // Get the available queues that we want
     QueueFamilyIndices indices = findQueueFamilies_(physicalDevice);
@@ -1054,8 +1639,46 @@ void GraphicsBase::createLogicalDevice_() {
     // Polygon fill
     deviceFeatures.fillModeNonSolid = VK_TRUE;
 
+    // Query optional features, descriptor indexing is chained when the device exposes it
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    bool descriptorIndexingAvailable = properties.apiVersion >= VK_API_VERSION_1_1
+        && isDeviceExtensionSupported_(physicalDevice, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures2 = {};
+    supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures2.pNext = descriptorIndexingAvailable ? &indexingFeatures : nullptr;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures2);
+    const VkPhysicalDeviceFeatures & supportedFeatures = supportedFeatures2.features;
+
     // Set anisotropy
-    deviceFeatures.samplerAnisotropy = VK_TRUE;
+    samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+    deviceFeatures.samplerAnisotropy = samplerAnisotropy ? VK_TRUE : VK_FALSE;
+
+    // Texture table indexing, per draw uniform indices only need dynamic indexing
+    deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+
+    bindlessTextures = descriptorIndexingAvailable
+        && indexingFeatures.shaderSampledImageArrayNonUniformIndexing
+        && indexingFeatures.runtimeDescriptorArray
+        && indexingFeatures.descriptorBindingPartiallyBound;
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT enabledIndexingFeatures = {};
+    enabledIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    enabledIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    enabledIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+    enabledIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+
+    const VkPhysicalDeviceLimits & limits = properties.limits;
+    textureTableSize = bindlessTextures
+        ? std::min({MAX_TEXTURE_TABLE_SIZE, limits.maxPerStageDescriptorSamplers, limits.maxPerStageDescriptorSampledImages})
+        : FALLBACK_TEXTURE_TABLE_SIZE;
+
+    // Dynamic allocations may be bound as any buffer type
+    dynamicAlignment = std::max({limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment, (VkDeviceSize) 16});
 
     // Logical device info struct creation
     VkDeviceCreateInfo createInfo = {};
@@ -1069,8 +1692,13 @@ void GraphicsBase::createLogicalDevice_() {
     createInfo.pEnabledFeatures = &deviceFeatures;
 
     // Add wanted device extensions
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    std::vector<const char*> enabledExtensions = getRequiredDeviceExtensions_();
+    if (bindlessTextures) {
+        enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        createInfo.pNext = &enabledIndexingFeatures;
+    }
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     // Add wanted validation layers
     if (enableValidationLayers) {
@@ -1135,12 +1763,19 @@ void GraphicsBase::createSwapChain_() {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = swapChain;
 
-    // Create the actual swapchain
-    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS)
+    // Create the actual swapchain, the previous one is retired once its last frame is done
+    VkSwapchainKHR newSwapChain;
+    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &newSwapChain) != VK_SUCCESS)
         throw std::runtime_error("failed to create swap chain!");
 
+    if (swapChain != VK_NULL_HANDLE) {
+        VkSwapchainKHR oldSwapChain = swapChain;
+        deferDestruction([=]() { vkDestroySwapchainKHR(device, oldSwapChain, nullptr); });
+    }
+    swapChain = newSwapChain;
+
     // Get the swapchain images
     vkGetSwapchainImagesKHR(device, swapChain, &imageCount, nullptr);
     swapChainImages.resize(imageCount);
@@ -1148,9 +1783,19 @@ void GraphicsBase::createSwapChain_() {
     
     // Get other parameters
     swapChainImageFormat = surfaceFormat.format;
+    swapChainPresentMode = presentMode;
     swapChainExtent = extent;
 }
 
+void GraphicsBase::createHeadlessTarget_(int width, int height) {
+    // Offscreen color target standing in for the swapchain images
+    swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    swapChainExtent = {(uint32_t) width, (uint32_t) height};
+    swapChainImages.resize(1);
+
+    createImage_(width, height, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &swapChainImages[0], &headlessImageMemory);
+}
+
 SwapChainSupportDetails GraphicsBase::querySwapChainSupport_(VkPhysicalDevice device) {
     // Support structure to return
     SwapChainSupportDetails details;
@@ -1188,11 +1833,16 @@ VkSurfaceFormatKHR GraphicsBase::chooseSwapSurfaceFormat_(const std::vector<VkSu
 }
 
 VkPresentModeKHR GraphicsBase::chooseSwapPresentMode_(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-    for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            return availablePresentMode;
-        }
-    }
+    auto available = [&](VkPresentModeKHR mode) {
+        return std::find(availablePresentModes.begin(), availablePresentModes.end(), mode) != availablePresentModes.end();
+    };
+
+    if (available(requestedPresentMode))
+        return requestedPresentMode;
+
+    // Mailbox is the closest uncapped mode without tearing, FIFO is always supported
+    if (requestedPresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR && available(VK_PRESENT_MODE_MAILBOX_KHR))
+        return VK_PRESENT_MODE_MAILBOX_KHR;
 
     return VK_PRESENT_MODE_FIFO_KHR;
 }
@@ -1274,16 +1924,19 @@ void GraphicsBase::recreateSwapChain_() {
         glfwGetFramebufferSize(window, &width, &height);
         glfwWaitEvents();
     }
-    
-    vkDeviceWaitIdle(device);
 
-    cleanupSwapChain_();
-    createRenderPass_();
+    // Frames in flight may still use the current views and framebuffers, retire them
+    // through the deletion queue rather than idling the device
+    for (auto framebuffer : swapChainFramebuffers)
+        destroyFramebuffer(framebuffer, nullptr);
+    for (auto imageView : swapChainImageViews)
+        destroyImageView(imageView, nullptr);
 
+    // The surface format does not change on resize, render pass and command buffers are kept
     createSwapChain_();
     createImageViews_();
     createFramebuffers_();
-    createCommandBuffers_();
+    imagesInFlight.assign(swapChainImages.size(), VK_NULL_HANDLE);
 
     for (auto drawable: drawables)
         drawable->resize(width, height);
@@ -1300,12 +1953,32 @@ void GraphicsBase::cleanupSwapChain_() {
     for (auto imageView : swapChainImageViews)
         vkDestroyImageView(device, imageView, nullptr);
     
-    vkDestroySwapchainKHR(device, swapChain, nullptr);
+    if (headless) {
+        vkDestroyImage(device, swapChainImages[0], nullptr);
+        vkFreeMemory(device, headlessImageMemory, nullptr);
+    } else {
+        vkDestroySwapchainKHR(device, swapChain, nullptr);
+    }
 }
 
 void GraphicsBase::cleanup_() {
+    // The device is idle, release everything still pending
+    flushDeletionQueue_(true);
+
+    vkUnmapMemory(device, dynamicMemory);
+    vkDestroyBuffer(device, dynamicBuffer, nullptr);
+    vkFreeMemory(device, dynamicMemory, nullptr);
+
+    vkDestroyDescriptorPool(device, textureTablePool, nullptr);
+    vkDestroyDescriptorSetLayout(device, textureTableLayout, nullptr);
+    vkDestroySampler(device, defaultTextureSampler, nullptr);
+    vkDestroyImageView(device, defaultTextureView, nullptr);
+    vkDestroyImage(device, defaultTextureImage, nullptr);
+    vkFreeMemory(device, defaultTextureMemory, nullptr);
+
     ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
+    if (!headless)
+        ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
     
     cleanupSwapChain_();
@@ -1325,10 +1998,12 @@ void GraphicsBase::cleanup_() {
     if (enableValidationLayers)
         DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
 
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (!headless)
+        vkDestroySurfaceKHR(instance, surface, nullptr);
     vkDestroyInstance(instance, nullptr);
 
-    glfwDestroyWindow(window);
-
-    glfwTerminate();
+    if (!headless) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 }
@@ -11,6 +11,9 @@
 #include <fstream>
 #include <optional>
 #include <chrono>
+#include <functional>
+#include <deque>
+#include <algorithm>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -23,6 +26,7 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_vulkan.h"
 #include "drawable.h"
+#include "frame_pacer.h"
 
 namespace uengine::graphics {
 
@@ -42,23 +46,84 @@ namespace uengine::graphics {
     };
 
 
+    // Color target of an offscreen pass, sampled by later passes or ImGui once the pass ends
+    struct OffscreenTarget {
+        int32_t width = 0, height = 0;
+        VkDeviceMemory mem;
+        VkImage image;
+        VkImageView view;
+        VkSampler sampler = VK_NULL_HANDLE; // Linear, clamped, unless created without one
+        VkFramebuffer frameBuffer;
+    };
+
+
     class GraphicsBase {
         public:
 
-            GraphicsBase(int width, int height);
+            GraphicsBase(int width, int height, bool headless = false);
 
             ~GraphicsBase();
 
             bool shouldClose();
             void poolEvents();
             void draw();
+
+            // Frame scheduling, waitFrame blocks until a frame slot is free and should be called
+            // before poolEvents so input is sampled as late as possible
+            void waitFrame();
+            size_t getCurrentFrame(); // Frame slot being recorded, for per-frame resources
+            size_t getFramesInFlight();
+            void setLowLatency(bool state); // Let at most one frame be queued on the GPU
+            bool isLowLatency();
+            float getLatencyEstimate(); // Milliseconds from input sampling to the end of the frame on the GPU
             void addDrawable(uengine::graphics::Drawable * drawable);
             VkDevice * getDevice();
+            bool isHeadless();
+            VkExtent2D getExtent();
+
+            // Headless read-back, RGBA8 rows from top to bottom
+            void readPixels(std::vector<uint8_t> & pixels);
+
+            // Presentation and pacing, a mode change recreates the swapchain on the next present
+            void setPresentMode(VkPresentModeKHR mode);
+            VkPresentModeKHR getPresentMode();
+            bool isPresentModeSupported(VkPresentModeKHR mode);
+            uengine::graphics::FramePacer * getFramePacer();
+
+            // Deferred destruction, run once every frame that may still use the objects has completed
+            void deferDestruction(std::function<void()> destroyer);
+            void removeTexture(ImTextureID texture);
+
+            // Global texture table, every registered texture gets a stable index usable in shaders.
+            // Index 0 is a white texture, freed indices are reused once no pending frame uses them.
+            // With descriptor indexing, a draw may index it freely, otherwise the index must be
+            // uniform within a draw and the table is limited to a few entries.
+            uint32_t registerTexture(VkImageView imageView, VkSampler sampler);
+            void unregisterTexture(uint32_t textureId);
+            VkDescriptorSetLayout getTextureTableLayout();
+            VkDescriptorSet getTextureTable(); // Table of the frame slot being recorded
+            uint32_t getTextureTableSize();
+            bool hasBindlessTextures();
+
+            // Per-frame dynamic memory, a persistently mapped buffer with one region per frame slot.
+            // Allocations come from the region of the slot being recorded and only live for that
+            // frame, writing them never races the GPU reading an older frame. Returned offsets are
+            // aligned for uniform, storage, vertex and index use, descriptors of type
+            // UNIFORM_BUFFER_DYNAMIC or STORAGE_BUFFER_DYNAMIC take them as dynamic offsets.
+            uint32_t allocateDynamic(VkDeviceSize size, void ** data);
+            uint32_t uploadDynamic(const void * data, VkDeviceSize size);
+            VkBuffer getDynamicBuffer();
             
             // Tools
             void createTextureImage(std::string filename, VkImage * textureImage, VkDeviceMemory * textureImageMemory, VkImageView * textureImageView, VkSampler * textureSampler, uint8_t ** data, int * w, int * h, bool keepData);
             void deleteTextureImage(VkImage * textureImage, VkDeviceMemory * textureImageMemory, VkImageView * textureImageView, VkSampler * textureSampler, uint8_t * data);
             
+            // Offscreen passes render to a single color attachment, cleared on load and left
+            // in SHADER_READ_ONLY_OPTIMAL for sampling
+            void createOffscreenRenderPass(VkFormat format, VkRenderPass * renderPass);
+            void createOffscreenTarget(VkRenderPass renderPass, VkFormat format, int32_t width, int32_t height, OffscreenTarget * target, bool sampler = true);
+            void destroyOffscreenTarget(OffscreenTarget * target); // Deferred like the other destroy calls
+            
             uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
             
             void createRenderPass(const VkRenderPassCreateInfo * info, const VkAllocationCallbacks * callback, VkRenderPass * renderPass);
@@ -106,7 +171,9 @@ namespace uengine::graphics {
 
             /* Low level variables */
             
-            GLFWwindow* window;
+            bool headless = false;
+
+            GLFWwindow* window = nullptr;
 
             VkInstance instance;
 
@@ -120,9 +187,13 @@ namespace uengine::graphics {
             uint32_t graphicsFamily;
             uint32_t presentFamily;
 
-            VkSwapchainKHR swapChain;
+            VkSwapchainKHR swapChain = VK_NULL_HANDLE;
             std::vector<VkImage> swapChainImages;
+            VkDeviceMemory headlessImageMemory = VK_NULL_HANDLE;
             VkFormat swapChainImageFormat;
+            VkPresentModeKHR swapChainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+            VkPresentModeKHR requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            bool presentModeChanged = false;
             VkExtent2D swapChainExtent;
 
             std::vector<VkImageView> swapChainImageViews;
@@ -139,10 +210,47 @@ namespace uengine::graphics {
             std::vector<VkFence> inFlightFences;
             std::vector<VkFence> imagesInFlight;
 
+            // Deferred destruction, tagged with the submission that has to complete first
+            std::deque<std::pair<uint64_t, std::function<void()>>> deletionQueue;
+            std::vector<uint64_t> frameSubmissions; // Last submission made on each frame slot
+            uint64_t submittedFrames = 0;
+            uint64_t completedFrames = 0;
+
+            // Latency tracking, input sampling time of the frame recorded on each slot
+            bool frameWaited = false;
+            bool lowLatency = true;
+            std::vector<std::chrono::steady_clock::time_point> frameInputTimes;
+            uint64_t measuredFrames = 0;
+            float latencyEstimate = 0.0f;
+
+            // Texture table, one descriptor set per frame slot so updates never touch a set in use
+            bool bindlessTextures = false;
+            uint32_t textureTableSize = 0;
+            VkDescriptorPool textureTablePool;
+            VkDescriptorSetLayout textureTableLayout;
+            std::vector<VkDescriptorSet> textureTableSets;
+            std::vector<VkDescriptorImageInfo> textureTable;
+            std::vector<uint32_t> freeTextureIds;
+            std::vector<std::vector<uint32_t>> dirtyTextureIds; // Entries to rewrite, per frame slot
+            VkImage defaultTextureImage;
+            VkDeviceMemory defaultTextureMemory;
+            VkImageView defaultTextureView;
+            VkSampler defaultTextureSampler;
+
+            // Dynamic memory, the region of a slot is reset once its fence has been waited on
+            VkBuffer dynamicBuffer;
+            VkDeviceMemory dynamicMemory;
+            uint8_t * dynamicData;
+            VkDeviceSize dynamicAlignment = 256;
+            VkDeviceSize dynamicHead = 0; // Used bytes in the region of the current slot
+
             size_t currentFrame = 0;
             uint32_t imageIndex = 0;
 
             bool framebufferResized = false;
+            uengine::graphics::FramePacer framePacer;
+            bool samplerAnisotropy = false;
+            std::chrono::time_point<std::chrono::high_resolution_clock> lastFrameTime = std::chrono::high_resolution_clock::now();
 
             VkDebugUtilsMessengerEXT debugMessenger;
 
@@ -151,12 +259,14 @@ namespace uengine::graphics {
 
             void initWindow_(int width, int height);
             static void framebufferResizeCallback_(GLFWwindow* window, int width, int height);
-            void initVulkan_();
+            void initVulkan_(int width, int height);
             void initImgui_();
 
             bool acquire_();
             void render_();
             void present_();
+            void flushDeletionQueue_(bool all = false);
+            void updateTextureTable_();
 
 
             // Initialization
@@ -175,6 +285,9 @@ namespace uengine::graphics {
             void createImageViews_();
             void createFramebuffers_();
             void createDescriptorPool_();
+            void createDefaultTexture_();
+            void createTextureTable_();
+            void createDynamicBuffer_();
             void createInstance_();
             std::vector<const char*> getRequiredExtensions_();
             void createSurface_();
@@ -182,8 +295,11 @@ namespace uengine::graphics {
             bool isDeviceSuitable_(VkPhysicalDevice device);
             QueueFamilyIndices findQueueFamilies_(VkPhysicalDevice device);
             bool checkDeviceExtensionSupport_(VkPhysicalDevice device);
+            std::vector<const char*> getRequiredDeviceExtensions_();
+            bool isDeviceExtensionSupported_(VkPhysicalDevice device, const char * extension);
             void createLogicalDevice_();
             void createSwapChain_();
+            void createHeadlessTarget_(int width, int height);
             SwapChainSupportDetails querySwapChainSupport_(VkPhysicalDevice device);
             VkSurfaceFormatKHR chooseSwapSurfaceFormat_(const std::vector<VkSurfaceFormatKHR>& availableFormats);
             VkPresentModeKHR chooseSwapPresentMode_(const std::vector<VkPresentModeKHR>& availablePresentModes);
@@ -10,8 +10,8 @@ GraphicsGrid::GraphicsGrid(GraphicsBase * gb_, VkRenderPass * renderPass_) {
     model = glm::mat4(1.0f);
     vp = glm::mat4(1.0f);
     ubo = {};
+    revisionUbo = {};
 
-    setupUBO();
     setupDescriptorPool();
     setupDescriptorSetLayout();
     setupDescriptorSet();
@@ -19,8 +19,6 @@ GraphicsGrid::GraphicsGrid(GraphicsBase * gb_, VkRenderPass * renderPass_) {
 }
 
 GraphicsGrid::~GraphicsGrid() {
-    gb->destroyBuffer(buffer, nullptr);
-    gb->freeMemory(memory, nullptr);
     gb->destroyPipeline(pipeline, nullptr);
     gb->destroyPipelineLayout(pipelineLayout, nullptr);
     gb->destroyDescriptorSetLayout(descriptorSetLayout, nullptr);
@@ -36,68 +34,66 @@ void GraphicsGrid::setBoundaries(float pos1[2], float pos2[2]) {
                 glm::scale(glm::mat4(1.0f), glm::vec3(std::abs(pos2[0] - pos1[0]) / 2, std::abs(pos2[1] - pos1[1]) / 2, 1.0f));
     ubo.invMVP = glm::inverse(vp * model);
     ubo.model = model;
-    updateUBO();
 }
 
 void GraphicsGrid::setColor1(float color[4]) {
     ubo.color1 = glm::make_vec4(color);
-    updateUBO();
 }
 
 void GraphicsGrid::setColor2(float color[4]) {
     ubo.color2 = glm::make_vec4(color);
-    updateUBO();
 }
 
 void GraphicsGrid::setXOffset(float offset) {
     ubo.offset = glm::vec2(ubo.offset.x, offset);
-    updateUBO();
 }
 
 void GraphicsGrid::setYOffset(float offset) {
     ubo.offset = glm::vec2(offset, ubo.offset.y);
-    updateUBO();
 }
 
 void GraphicsGrid::setOffset(float offset[2]) {
     ubo.offset = glm::make_vec2(offset);
-    updateUBO();
 }
 
 void GraphicsGrid::setXTileSize(float tileSize) {
     ubo.tileSize = glm::vec2(ubo.tileSize.x, tileSize);
-    updateUBO();
 }
 
 void GraphicsGrid::setYTileSize(float tileSize) {
     ubo.tileSize = glm::vec2(tileSize, ubo.tileSize.y);
-    updateUBO();
 }
 
 void GraphicsGrid::setTileSize(float tileSize[2]) {
     ubo.tileSize = glm::make_vec2(tileSize);
-    updateUBO();
 }
 
 void GraphicsGrid::setScreenSize(float screenSize[2]) {
     ubo.screenSize = glm::make_vec2(screenSize);
-    updateUBO();
 }
 
 void GraphicsGrid::setExtended(bool state) {
     ubo.extended = state;
-    updateUBO();
 }
 
 void GraphicsGrid::setViewProjection(glm::mat4 vp_) {
     vp = vp_;
     ubo.invMVP = glm::inverse(vp * model);
-    updateUBO();
+}
+
+uint64_t GraphicsGrid::getRevision() {
+    // Setters are called with unchanged values all the time, only a different uniform block counts
+    if (memcmp(&ubo, &revisionUbo, sizeof(ubo)) != 0) {
+        revisionUbo = ubo;
+        revision++;
+    }
+    return revision;
 }
 
 void GraphicsGrid::render(VkCommandBuffer cb) {
     vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    uint32_t offset = gb->uploadDynamic(&ubo, sizeof(ubo));
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 1, &offset);
     vkCmdDraw(cb, 6, 1, 0, 0);
 }
 
@@ -107,7 +103,7 @@ void GraphicsGrid::render(VkCommandBuffer cb) {
 
 void GraphicsGrid::setupDescriptorPool() {
     std::vector<VkDescriptorPoolSize> poolSizes = {
-        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 16),
+        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 16),
     };
 
     VkDescriptorPoolCreateInfo descriptorPoolInfo =
@@ -119,7 +115,7 @@ void GraphicsGrid::setupDescriptorPool() {
 void GraphicsGrid::setupDescriptorSetLayout() {
     // Binding
     std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings = {
-        gh::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        gh::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                        VK_SHADER_STAGE_FRAGMENT_BIT,
                                        0),
     };
@@ -136,11 +132,11 @@ void GraphicsGrid::setupDescriptorSet() {
     gb->allocateDescriptorSets(&allocInfo, &descriptorSet);
 
     VkDescriptorBufferInfo bufferInfo =
-        gh::descriptorBufferInfo(buffer, 0, sizeof(ubo));
+        gh::descriptorBufferInfo(gb->getDynamicBuffer(), 0, sizeof(ubo));
     
     std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
         gh::writeDescriptorSet(descriptorSet,
-                               VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                               VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                0,
                                &bufferInfo)
     };
@@ -245,18 +241,3 @@ void GraphicsGrid::setupPipeline() {
     gb->destroyShaderModule(vertShaderModule, nullptr);
     gb->destroyShaderModule(fragShaderModule, nullptr);
 }
-
-void GraphicsGrid::setupUBO() {
-    gb->createBuffer(sizeof(ubo),
-                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     buffer,
-                     memory);
-}
-
-void GraphicsGrid::updateUBO() {
-    void * data;
-    gb->mapMemory(memory, 0, sizeof(ubo), 0, &data);
-    memcpy(data, &ubo, sizeof(ubo));
-    gb->unmapMemory(memory);
-}
@@ -35,6 +35,7 @@ namespace uengine::graphics {
             void setScreenSize(float screenSize[2]);
             void setExtended(bool state);
             void setViewProjection(glm::mat4 vp);
+            uint64_t getRevision(); // Bumped whenever the drawn result may change
             
             void render(VkCommandBuffer cb);
 
@@ -53,9 +54,8 @@ namespace uengine::graphics {
                 alignas(8) glm::vec2 tileSize;
                 alignas(8) glm::vec2 screenSize;
                 alignas(4) float extended;
-            } ubo;
-            VkBuffer buffer;
-            VkDeviceMemory memory;
+            } ubo, revisionUbo; // Written to the frame's dynamic memory when rendered, and as of the last revision
+            uint64_t revision = 1;
 
             VkDescriptorPool descriptorPool;
             VkDescriptorSetLayout descriptorSetLayout;
@@ -67,8 +67,6 @@ namespace uengine::graphics {
             void setupDescriptorSetLayout();
             void setupDescriptorSet();
             void setupPipeline();
-            void setupUBO();
-            void updateUBO();
     };
 
 }
@@ -350,4 +350,20 @@ namespace uengine::graphics::helper {
         return pipelineLayoutCreateInfo;
     }
 
+    VkPushConstantRange pushConstantRange(
+        VkShaderStageFlags stageFlags,
+        uint32_t size,
+        uint32_t offset) {
+        VkPushConstantRange pushConstantRange {};
+        pushConstantRange.stageFlags = stageFlags;
+        pushConstantRange.offset = offset;
+        pushConstantRange.size = size;
+        return pushConstantRange;
+    }
+
+    uint32_t packColor(glm::vec4 color) {
+        glm::uvec4 c = glm::uvec4(glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+        return c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
+    }
+
 }
@@ -14,6 +14,8 @@
 #include <chrono>
 
 #include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
 
 namespace uengine::graphics::helper {
 
@@ -175,6 +177,16 @@ namespace uengine::graphics::helper {
 
     VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo(
         uint32_t setLayoutCount = 1);
+
+    VkPushConstantRange pushConstantRange(
+        VkShaderStageFlags stageFlags,
+        uint32_t size,
+        uint32_t offset = 0);
+
+    /* Color */
+
+    // Clamped RGBA8, red in the low byte, as read by unpackUnorm4x8 in the shaders
+    uint32_t packColor(glm::vec4 color);
 }
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef GRAPHICS_QUADS_H
 #define GRAPHICS_QUADS_H
 
+#include <array>
 #include <iostream>
 #include <vector>
 
@@ -17,15 +18,27 @@
 
 namespace uengine::graphics {
 
+    // Axis aligned rectangles, filled or outlined. Each one is a 20 byte instance record (two
+    // corners and an RGBA8 color) that the vertex shader expands into two triangles, outlines
+    // are cut in the fragment shader so they work without wide line support.
+    // Rectangles keep a stable handle until removed, freed slots are reused by later adds.
+    // Each frame slot keeps its own instance buffers, grown geometrically, and only the range
+    // of instances changed since that slot was last drawn is written again.
     class GraphicsQuads {
         public:
-            GraphicsQuads(GraphicsBase * gb, VkRenderPass * renderPass, int nbQuadsMax, float lineWidth);
+            typedef uint32_t Handle;
+
+            GraphicsQuads(GraphicsBase * gb, VkRenderPass * renderPass, int nbQuadsHint, float lineWidth); // Hint sizes the first buffers, line width is in pixels
             ~GraphicsQuads();
             
-            void addQuad(float pos1[2], float pos2[2], float pos3[2], float pos4[2], float color[4], bool filled);
-            void addRect(float pos1[2], float pos2[2], float color[4], bool filled);
-            void addRect(float x1, float y1, float x2, float y2, float r, float g, float b, float a, bool filled);
+            Handle addRect(float pos1[2], float pos2[2], float color[4], bool filled);
+            Handle addRect(float x1, float y1, float x2, float y2, float r, float g, float b, float a, bool filled);
+            void setRect(Handle handle, float x1, float y1, float x2, float y2, float r, float g, float b, float a);
+            void remove(Handle handle);
             void clear();
+            void reserve(int nbQuads);
+            size_t getUploadedBytes(); // Instance bytes written by the last render
+            uint64_t getRevision();    // Bumped whenever the drawn result may change
 
             void setViewProjection(glm::mat4 vp);
             void render(VkCommandBuffer cb);
@@ -33,58 +46,51 @@ namespace uengine::graphics {
         private:
             GraphicsBase * gb;
             VkRenderPass * renderPass;
-            int nbQuadsMax;
-            float lineWidth;
-            int nbWire;
-            int nbFilled;
-
-            // VERTICES
-            struct Vertex {
-                glm::vec2 pos;
-                glm::vec4 color;
+            int nbQuadsHint;
+            size_t uploadedBytes = 0;
+            uint64_t revision = 1;
+
+            struct QuadInstance {
+                glm::vec2 pos1;
+                glm::vec2 pos2;
+                uint32_t color; // RGBA8
             };
-            VkBuffer wireVertexBuffer;
-            VkDeviceMemory wireVertexMemory;
-            VkBuffer filledVertexBuffer;
-            VkDeviceMemory filledVertexMemory;
-            
-            // INDICES
-            VkBuffer wireIndexBuffer;
-            VkDeviceMemory wireIndexMemory;
-            VkBuffer filledIndexBuffer;
-            VkDeviceMemory filledIndexMemory;
-            
-            // QUAD
-            struct Quad {
-                Vertex vertices[4];
-                bool filled;
+
+            // One pool per kind, a handle is the slot index shifted left with the kind in bit 0.
+            // Removed slots hold an empty rectangle until reused.
+            enum { FILLED = 0, WIRE = 1 };
+            struct Pool {
+                std::vector<QuadInstance> instances;
+                std::vector<uint32_t> freeSlots;
             };
-            std::vector<struct Quad> quads;
-
-            // UBO
-            struct {
-                glm::mat4 vp;
-            } ubo;
-            VkBuffer uboBuffer;
-            VkDeviceMemory uboMemory;
-
-            VkDescriptorPool descriptorPool;
-            VkDescriptorSetLayout descriptorSetLayout;
-            VkDescriptorSet descriptorSet;
-            VkPipelineLayout wirePipelineLayout;
-            VkPipelineLayout filledPipelineLayout;
-            VkPipeline wirePipeline;
-            VkPipeline filledPipeline;
-
-            void setupDescriptorPool();
-            void setupDescriptorSetLayout();
-            void setupDescriptorSet();
-            void setupWirePipeline();
-            void setupFilledPipeline();
-            void setupVertexBuffers();
-            void setupIndexBuffers();
-            void setupUBO();
-            void update();
+            std::array<Pool, 2> pools;
+
+            struct PoolBuffer {
+                VkBuffer buffer = VK_NULL_HANDLE;
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                QuadInstance * instances = nullptr; // Persistently mapped
+                size_t capacity = 0;                // In instances
+                uint32_t dirtyBegin = 0;            // Instance range this buffer is missing
+                uint32_t dirtyEnd = 0;
+            };
+            struct FrameResources {
+                std::array<PoolBuffer, 2> pools;
+            };
+            std::vector<FrameResources> frames;
+
+            struct PushConstants {
+                alignas(16) glm::mat4 vp;
+                alignas(4) float lineWidth;
+                alignas(4) uint32_t wire;
+            } pushConstants;
+
+            VkPipelineLayout pipelineLayout;
+            VkPipeline pipeline;
+
+            void markDirty(int kind, uint32_t begin, uint32_t end);
+            void upload(int kind, PoolBuffer & poolBuffer);
+            void destroyPoolBuffer(PoolBuffer & poolBuffer);
+            void setupPipeline();
     };
 
 }
@@ -0,0 +1,695 @@
+#include "lighting_renderer.h"
+
+using namespace uengine::graphics;
+using GraphicsBase = uengine::graphics::GraphicsBase;
+namespace gh = uengine::graphics::helper;
+
+LightingRenderer::LightingRenderer(GraphicsBase * gb_, uint32_t maxLights_) {
+    gb = gb_;
+    maxLights = maxLights_;
+
+    setupSampler();
+    gb->createOffscreenRenderPass(VK_FORMAT_R8_UNORM, &occlusionRenderPass);
+    gb->createOffscreenRenderPass(VK_FORMAT_R8G8B8A8_UNORM, &lightRenderPass);
+    setupLightBuffers();
+    setupDescriptorSetLayout();
+    setupOcclusionPipeline();
+    setupLightPipeline();
+}
+
+LightingRenderer::~LightingRenderer() {
+    if (offscreen.texture)
+        destroyOffscreen();
+    for (auto & frame : frames) {
+        gb->unmapMemory(frame.lightMemory);
+        gb->destroyBuffer(frame.lightBuffer, nullptr);
+        gb->freeMemory(frame.lightMemory, nullptr);
+    }
+    if (occluderBuffer != VK_NULL_HANDLE) {
+        gb->destroyBuffer(occluderBuffer, nullptr);
+        gb->freeMemory(occluderMemory, nullptr);
+    }
+    gb->destroyPipeline(occlusionPipeline, nullptr);
+    gb->destroyPipelineLayout(occlusionPipelineLayout, nullptr);
+    gb->destroyPipeline(lightPipeline, nullptr);
+    gb->destroyPipelineLayout(lightPipelineLayout, nullptr);
+    gb->destroyDescriptorSetLayout(descriptorSetLayout, nullptr);
+    gb->destroyRenderPass(occlusionRenderPass, nullptr);
+    gb->destroyRenderPass(lightRenderPass, nullptr);
+    gb->destroySampler(sampler, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void LightingRenderer::resize(int32_t width, int32_t height) {
+    if (offscreen.width == width && offscreen.height == height)
+        return;
+
+    offscreen.width = width;
+    offscreen.height = height;
+    offscreen.tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    offscreen.tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    if (width == 0 || height == 0)
+        return;
+
+    // Render into a sub-rect of the current targets as long as it fits, and only
+    // reallocate targets, tile lists and descriptors when growing past them or when
+    // most of them would go unused
+    bool fits = width <= offscreen.light.width && height <= offscreen.light.height;
+    bool wasteful = width < offscreen.light.width / 2 && height < offscreen.light.height / 2;
+    if (!offscreen.texture || !fits || wasteful) {
+        if (offscreen.texture)
+            destroyOffscreen();
+        setupOffscreen(width, height);
+        setupDescriptorSets();
+    }
+}
+
+void LightingRenderer::setViewProjection(glm::mat4 vp_) {
+    vp = vp_;
+}
+
+void LightingRenderer::setAmbient(glm::vec3 ambient_) {
+    ambient = ambient_;
+}
+
+void LightingRenderer::setShadowSteps(uint32_t steps) {
+    shadowSteps = steps;
+}
+
+void LightingRenderer::clearLights() {
+    lights.clear();
+}
+
+void LightingRenderer::addLight(const Light & light) {
+    if (lights.size() >= maxLights)
+        return;
+    lights.push_back(light);
+}
+
+void LightingRenderer::clearOccluders() {
+    occluderVertices.clear();
+    occludersChanged = true;
+}
+
+void LightingRenderer::addOccluder(const std::vector<glm::vec2> & polygon) {
+    triangulate(polygon, occluderVertices);
+    occludersChanged = true;
+}
+
+void LightingRenderer::render(VkCommandBuffer cb) {
+    if (!offscreen.texture || offscreen.width == 0 || offscreen.height == 0)
+        return;
+
+    // The frame slot has been waited on, its light and tile buffers are free to overwrite
+    FrameResources & frame = frames[gb->getCurrentFrame()];
+    cullLights(frame);
+
+    if (occludersChanged)
+        uploadOccluders();
+
+    VkViewport viewport = gh::viewport((float) offscreen.width, (float) offscreen.height, 0.0f, 1.0f);
+    VkRect2D scissor = gh::rect2D(offscreen.width, offscreen.height, 0, 0);
+    VkClearValue clearValues = {0};
+
+    // Occlusion pass, cleared whole so shadow rays leaving the sub-rect march through empty space
+    VkRenderPassBeginInfo renderPassBeginInfo = gh::renderPassBeginInfo();
+    renderPassBeginInfo.renderPass = occlusionRenderPass;
+    renderPassBeginInfo.framebuffer = offscreen.occlusion.frameBuffer;
+    renderPassBeginInfo.renderArea.extent.width = offscreen.occlusion.width;
+    renderPassBeginInfo.renderArea.extent.height = offscreen.occlusion.height;
+    renderPassBeginInfo.clearValueCount = 1;
+    renderPassBeginInfo.pClearValues = &clearValues;
+
+    vkCmdBeginRenderPass(cb, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdSetViewport(cb, 0, 1, &viewport);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+
+    if (!occluderVertices.empty()) {
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, occlusionPipeline);
+        vkCmdPushConstants(cb, occlusionPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &vp);
+        vkCmdBindVertexBuffers(cb, 0, 1, &occluderBuffer, offsets);
+        vkCmdDraw(cb, static_cast<uint32_t>(occluderVertices.size()), 1, 0, 0);
+    }
+
+    vkCmdEndRenderPass(cb);
+
+    // Illumination pass, the render pass dependency makes the mask readable
+    IlluminationConstants constants;
+    constants.ambient = glm::vec4(ambient, 1.0f);
+    constants.targetSize = glm::vec2((float) offscreen.occlusion.width, (float) offscreen.occlusion.height);
+    constants.tilesX = offscreen.tilesX;
+    constants.shadowSteps = shadowSteps;
+
+    renderPassBeginInfo.renderPass = lightRenderPass;
+    renderPassBeginInfo.framebuffer = offscreen.light.frameBuffer;
+    renderPassBeginInfo.renderArea.extent.width = offscreen.width;
+    renderPassBeginInfo.renderArea.extent.height = offscreen.height;
+
+    vkCmdBeginRenderPass(cb, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdSetViewport(cb, 0, 1, &viewport);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, lightPipeline);
+    vkCmdPushConstants(cb, lightPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(IlluminationConstants), &constants);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, lightPipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdDraw(cb, 3, 1, 0, 0);
+
+    vkCmdEndRenderPass(cb);
+}
+
+ImTextureID LightingRenderer::getTexture() {
+    return offscreen.texture;
+}
+
+ImVec2 LightingRenderer::getTextureUV() {
+    if (!offscreen.texture)
+        return ImVec2(1.0f, 1.0f);
+    return ImVec2((float) offscreen.width / offscreen.light.width, (float) offscreen.height / offscreen.light.height);
+}
+
+VkImageView LightingRenderer::getLightMapView() {
+    return offscreen.light.view;
+}
+
+VkSampler LightingRenderer::getSampler() {
+    return sampler;
+}
+
+uint32_t LightingRenderer::getLightCount() {
+    return lightCount;
+}
+
+uint32_t LightingRenderer::getOccluderTriangleCount() {
+    return occluderVertices.size() / 3;
+}
+
+float LightingRenderer::getAverageLightsPerTile() {
+    return averageLightsPerTile;
+}
+
+float LightingRenderer::getCullTime() {
+    return cullTime;
+}
+
+void LightingRenderer::triangulate(const std::vector<glm::vec2> & polygon, std::vector<glm::vec2> & triangles) {
+    // Ear clipping, fine for the small outlines occluders are made of
+    size_t n = polygon.size();
+    if (n < 3)
+        return;
+
+    float area = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        const glm::vec2 & a = polygon[i];
+        const glm::vec2 & b = polygon[(i + 1) % n];
+        area += a.x * b.y - b.x * a.y;
+    }
+
+    // Work counter-clockwise
+    std::vector<size_t> indices(n);
+    for (size_t i = 0; i < n; i++)
+        indices[i] = area >= 0.0f ? i : n - 1 - i;
+
+    auto cross = [](glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    };
+
+    while (indices.size() > 3) {
+        size_t count = indices.size();
+        bool clipped = false;
+
+        for (size_t i = 0; i < count; i++) {
+            glm::vec2 a = polygon[indices[(i + count - 1) % count]];
+            glm::vec2 b = polygon[indices[i]];
+            glm::vec2 c = polygon[indices[(i + 1) % count]];
+
+            // Reflex vertices are not ears
+            if (cross(a, b, c) <= 0.0f)
+                continue;
+
+            bool ear = true;
+            for (size_t j = 0; j < count && ear; j++) {
+                if (j == i || j == (i + count - 1) % count || j == (i + 1) % count)
+                    continue;
+                glm::vec2 p = polygon[indices[j]];
+                ear = !(cross(a, b, p) >= 0.0f && cross(b, c, p) >= 0.0f && cross(c, a, p) >= 0.0f);
+            }
+            if (!ear)
+                continue;
+
+            triangles.push_back(a);
+            triangles.push_back(b);
+            triangles.push_back(c);
+            indices.erase(indices.begin() + i);
+            clipped = true;
+            break;
+        }
+
+        // Self intersecting or degenerate outline, fan what is left rather than looping forever
+        if (!clipped) {
+            for (size_t i = 1; i + 1 < indices.size(); i++) {
+                triangles.push_back(polygon[indices[0]]);
+                triangles.push_back(polygon[indices[i]]);
+                triangles.push_back(polygon[indices[i + 1]]);
+            }
+            return;
+        }
+    }
+
+    triangles.push_back(polygon[indices[0]]);
+    triangles.push_back(polygon[indices[1]]);
+    triangles.push_back(polygon[indices[2]]);
+}
+
+/*
+ *  Internal methods
+ */
+
+void LightingRenderer::cullLights(FrameResources & frame) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    uint32_t tileCount = offscreen.tilesX * offscreen.tilesY;
+    uint32_t stride = MAX_LIGHTS_PER_TILE + 1;
+    for (uint32_t tile = 0; tile < tileCount; tile++)
+        frame.tiles[tile * stride] = 0;
+
+    // World to pixels, lights are assumed to be circles after projection (2D camera without shear)
+    glm::vec2 size((float) offscreen.width, (float) offscreen.height);
+    float pixelScale = glm::length(glm::vec2(vp[0])) * size.x * 0.5f;
+
+    lightCount = 0;
+    uint64_t binned = 0;
+    for (auto & light : lights) {
+        glm::vec4 clip = vp * glm::vec4(light.position, 0.0f, 1.0f);
+        glm::vec2 pixel = (glm::vec2(clip) / clip.w * 0.5f + 0.5f) * size;
+        float radius = light.radius * pixelScale;
+
+        // Tiles overlapped by the light's bounding square
+        glm::vec2 lower = glm::floor((pixel - radius) / (float) TILE_SIZE);
+        glm::vec2 upper = glm::floor((pixel + radius) / (float) TILE_SIZE);
+        if (upper.x < 0.0f || upper.y < 0.0f || lower.x >= offscreen.tilesX || lower.y >= offscreen.tilesY)
+            continue;
+
+        glm::uvec2 first = glm::uvec2(glm::max(lower, glm::vec2(0.0f)));
+        glm::uvec2 last = glm::uvec2(glm::min(upper, glm::vec2((float) offscreen.tilesX - 1, (float) offscreen.tilesY - 1)));
+
+        uint32_t index = lightCount++;
+        frame.lights[index] = {pixel, radius, light.intensity, glm::vec4(light.color, 1.0f)};
+
+        for (uint32_t y = first.y; y <= last.y; y++) {
+            for (uint32_t x = first.x; x <= last.x; x++) {
+                uint32_t * tile = frame.tiles + (y * offscreen.tilesX + x) * stride;
+                if (tile[0] < MAX_LIGHTS_PER_TILE) {
+                    tile[1 + tile[0]] = index;
+                    tile[0]++;
+                    binned++;
+                }
+            }
+        }
+    }
+
+    averageLightsPerTile = tileCount ? (float) binned / tileCount : 0.0f;
+    cullTime = ((std::chrono::duration<float, std::milli>) (std::chrono::high_resolution_clock::now() - start)).count();
+}
+
+void LightingRenderer::uploadOccluders() {
+    occludersChanged = false;
+    if (occluderVertices.empty())
+        return;
+
+    // Pending frames may still draw the previous buffer, it goes through deferred destruction
+    if (occluderBuffer != VK_NULL_HANDLE) {
+        gb->destroyBuffer(occluderBuffer, nullptr);
+        gb->freeMemory(occluderMemory, nullptr);
+    }
+    gb->createBuffer(
+        occluderVertices.size() * sizeof(glm::vec2),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        occluderBuffer,
+        occluderMemory);
+
+    void * data;
+    gb->mapMemory(occluderMemory, 0, occluderVertices.size() * sizeof(glm::vec2), 0, &data);
+        memcpy(data, occluderVertices.data(), occluderVertices.size() * sizeof(glm::vec2));
+    gb->unmapMemory(occluderMemory);
+}
+
+
+/*----------------- Resources ----------------*/
+
+void LightingRenderer::setupSampler() {
+    // Nearest, the mask is sampled per pixel and the light map is displayed 1:1
+    VkSamplerCreateInfo samplerInfo = gh::samplerCreateInfo();
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = samplerInfo.addressModeU;
+    samplerInfo.addressModeW = samplerInfo.addressModeU;
+    samplerInfo.maxLod = 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+
+    gb->createSampler(&samplerInfo, nullptr, &sampler);
+}
+
+void LightingRenderer::setupLightBuffers() {
+    frames.resize(gb->getFramesInFlight());
+
+    for (auto & frame : frames) {
+        gb->createBuffer(
+            std::max<uint32_t>(maxLights, 1) * sizeof(LightData),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.lightBuffer,
+            frame.lightMemory);
+
+        void * data;
+        gb->mapMemory(frame.lightMemory, 0, VK_WHOLE_SIZE, 0, &data);
+        frame.lights = (LightData *) data;
+    }
+}
+
+void LightingRenderer::setupOffscreen(int32_t width, int32_t height) {
+    // A quarter of slack, rounded to 64 pixels, absorbs continuous window resizes
+    int32_t capacityWidth = ((width + width / 4 + 63) / 64) * 64;
+    int32_t capacityHeight = ((height + height / 4 + 63) / 64) * 64;
+
+    // Both targets are read through the shared nearest sampler
+    gb->createOffscreenTarget(occlusionRenderPass, VK_FORMAT_R8_UNORM, capacityWidth, capacityHeight, &offscreen.occlusion, false);
+    gb->createOffscreenTarget(lightRenderPass, VK_FORMAT_R8G8B8A8_UNORM, capacityWidth, capacityHeight, &offscreen.light, false);
+
+    // Tile lists follow the target capacity, any sub-rect that fits has its tiles
+    VkDeviceSize tileCount = (VkDeviceSize) (capacityWidth / TILE_SIZE) * (capacityHeight / TILE_SIZE);
+    VkDeviceSize tileBufferSize = tileCount * (MAX_LIGHTS_PER_TILE + 1) * sizeof(uint32_t);
+    for (auto & frame : frames) {
+        gb->createBuffer(
+            tileBufferSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.tileBuffer,
+            frame.tileMemory);
+
+        void * data;
+        gb->mapMemory(frame.tileMemory, 0, VK_WHOLE_SIZE, 0, &data);
+        frame.tiles = (uint32_t *) data;
+    }
+
+    offscreen.texture = ImGui_ImplVulkan_AddTexture(sampler, offscreen.light.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void LightingRenderer::destroyOffscreen() {
+    // Everything goes through deferred destruction, the pool takes the sets with it
+    gb->removeTexture(offscreen.texture);
+    gb->destroyOffscreenTarget(&offscreen.occlusion);
+    gb->destroyOffscreenTarget(&offscreen.light);
+    for (auto & frame : frames) {
+        gb->unmapMemory(frame.tileMemory);
+        gb->destroyBuffer(frame.tileBuffer, nullptr);
+        gb->freeMemory(frame.tileMemory, nullptr);
+        frame.tileBuffer = VK_NULL_HANDLE;
+    }
+    gb->destroyDescriptorPool(descriptorPool, nullptr);
+    descriptorPool = VK_NULL_HANDLE;
+
+    offscreen.texture = nullptr;
+}
+
+
+/*----------------- Descriptors ----------------*/
+
+void LightingRenderer::setupDescriptorSetLayout() {
+    std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings = {
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            0),
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            1),
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            2)
+    };
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayoutInfo =
+        gh::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    gb->createDescriptorSetLayout(&descriptorLayoutInfo, nullptr, &descriptorSetLayout);
+}
+
+void LightingRenderer::setupDescriptorSets() {
+    // Recreated with the targets, sets of pending frames live on in the previous pool
+    uint32_t framesInFlight = frames.size();
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * framesInFlight),
+        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight)
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo =
+        gh::descriptorPoolCreateInfo(
+            poolSizes.size(),
+            poolSizes.data(),
+            framesInFlight);
+
+    gb->createDescriptorPool(&descriptorPoolInfo, nullptr, &descriptorPool);
+
+    for (auto & frame : frames) {
+        VkDescriptorSetAllocateInfo allocInfo =
+            gh::descriptorSetAllocateInfo(
+                descriptorPool,
+                &descriptorSetLayout,
+                1);
+
+        gb->allocateDescriptorSets(&allocInfo, &frame.descriptorSet);
+
+        VkDescriptorBufferInfo lightBufferInfo = gh::descriptorBufferInfo(frame.lightBuffer, 0, VK_WHOLE_SIZE);
+        VkDescriptorBufferInfo tileBufferInfo = gh::descriptorBufferInfo(frame.tileBuffer, 0, VK_WHOLE_SIZE);
+        VkDescriptorImageInfo occlusionInfo =
+            gh::descriptorImageInfo(
+                sampler,
+                offscreen.occlusion.view,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            gh::writeDescriptorSet(
+                frame.descriptorSet,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                0,
+                &lightBufferInfo),
+            gh::writeDescriptorSet(
+                frame.descriptorSet,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                1,
+                &tileBufferInfo),
+            gh::writeDescriptorSet(
+                frame.descriptorSet,
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                2,
+                &occlusionInfo)
+        };
+
+        gb->updateDescriptorSets(static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
+}
+
+
+/*---------------- Pipelines -----------------*/
+
+void LightingRenderer::setupOcclusionPipeline() {
+    // Shaders
+    VkShaderModule vertShaderModule = gb->createShaderModule("res/shaders/lighting/occlusion/vert.spv");
+    VkShaderModule fragShaderModule = gb->createShaderModule("res/shaders/lighting/occlusion/frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+    shaderStages[0] = gh::pipelineShaderStageCreateInfo(vertShaderModule, VK_SHADER_STAGE_VERTEX_BIT);
+    shaderStages[1] = gh::pipelineShaderStageCreateInfo(fragShaderModule, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Vertex input, world space triangle list
+    VkPipelineVertexInputStateCreateInfo vertexInputState = gh::pipelineVertexInputStateCreateInfo();
+
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions = {
+        gh::vertexInputBindingDescription(0, sizeof(glm::vec2), VK_VERTEX_INPUT_RATE_VERTEX)
+    };
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = {
+        gh::vertexInputAttributeDescription(0, 0, VK_FORMAT_R32G32_SFLOAT, 0)
+    };
+
+    vertexInputState.vertexBindingDescriptionCount = bindingDescriptions.size();
+    vertexInputState.pVertexBindingDescriptions = bindingDescriptions.data();
+    vertexInputState.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInputState.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState =
+        gh::pipelineInputAssemblyStateCreateInfo(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            0,
+            VK_FALSE);
+
+    // Viewport
+    VkPipelineViewportStateCreateInfo viewportState = gh::pipelineViewportStateCreateInfo(1, 1, 0);
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizationState =
+        gh::pipelineRasterizationStateCreateInfo(
+            VK_POLYGON_MODE_FILL,
+            VK_CULL_MODE_NONE,
+            VK_FRONT_FACE_CLOCKWISE,
+            0);
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampleState =
+        gh::pipelineMultisampleStateCreateInfo(
+            VK_SAMPLE_COUNT_1_BIT,
+            0);
+
+    // Color blend attachment, the mask is binary
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState =
+        gh::pipelineColorBlendAttachmentState(
+            VK_COLOR_COMPONENT_R_BIT,
+            VK_FALSE);
+
+    // Color blend state
+    VkPipelineColorBlendStateCreateInfo colorBlendState =
+        gh::pipelineColorBlendStateCreateInfo(
+            1,
+            &colorBlendAttachmentState);
+
+    // Dynamic state
+    std::vector<VkDynamicState> dynamicStateEnables = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState =
+        gh::pipelineDynamicStateCreateInfo(
+            dynamicStateEnables.data(),
+            dynamicStateEnables.size(),
+            0);
+
+    // Pipeline layout creation, view projection goes through push constants
+    VkPushConstantRange pushConstantRange = gh::pushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = gh::pipelineLayoutCreateInfo(0);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    gb->createPipelineLayout(&pipelineLayoutInfo, nullptr, &occlusionPipelineLayout);
+
+    // Actual pipeline creation
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = gh::pipelineCreateInfo(occlusionPipelineLayout, occlusionRenderPass, 0);
+    pipelineCreateInfo.pVertexInputState = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState = &multisampleState;
+    pipelineCreateInfo.pViewportState = &viewportState;
+    pipelineCreateInfo.pDynamicState = &dynamicState;
+    pipelineCreateInfo.stageCount = shaderStages.size();
+    pipelineCreateInfo.pStages = shaderStages.data();
+
+    gb->createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &occlusionPipeline);
+
+    // Cleanup
+    gb->destroyShaderModule(vertShaderModule, nullptr);
+    gb->destroyShaderModule(fragShaderModule, nullptr);
+}
+
+void LightingRenderer::setupLightPipeline() {
+    // Shaders
+    VkShaderModule vertShaderModule = gb->createShaderModule("res/shaders/lighting/light/vert.spv");
+    VkShaderModule fragShaderModule = gb->createShaderModule("res/shaders/lighting/light/frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+    shaderStages[0] = gh::pipelineShaderStageCreateInfo(vertShaderModule, VK_SHADER_STAGE_VERTEX_BIT);
+    shaderStages[1] = gh::pipelineShaderStageCreateInfo(fragShaderModule, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Vertex input, the fullscreen triangle is hardcoded in the shader
+    VkPipelineVertexInputStateCreateInfo vertexInputState = gh::pipelineVertexInputStateCreateInfo();
+    vertexInputState.vertexBindingDescriptionCount = 0;
+    vertexInputState.vertexAttributeDescriptionCount = 0;
+
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState =
+        gh::pipelineInputAssemblyStateCreateInfo(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            0,
+            VK_FALSE);
+
+    // Viewport
+    VkPipelineViewportStateCreateInfo viewportState = gh::pipelineViewportStateCreateInfo(1, 1, 0);
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizationState =
+        gh::pipelineRasterizationStateCreateInfo(
+            VK_POLYGON_MODE_FILL,
+            VK_CULL_MODE_NONE,
+            VK_FRONT_FACE_CLOCKWISE,
+            0);
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampleState =
+        gh::pipelineMultisampleStateCreateInfo(
+            VK_SAMPLE_COUNT_1_BIT,
+            0);
+
+    // Color blend attachment, every pixel is written once
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState =
+        gh::pipelineColorBlendAttachmentState(
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+            VK_FALSE);
+
+    // Color blend state
+    VkPipelineColorBlendStateCreateInfo colorBlendState =
+        gh::pipelineColorBlendStateCreateInfo(
+            1,
+            &colorBlendAttachmentState);
+
+    // Dynamic state
+    std::vector<VkDynamicState> dynamicStateEnables = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState =
+        gh::pipelineDynamicStateCreateInfo(
+            dynamicStateEnables.data(),
+            dynamicStateEnables.size(),
+            0);
+
+    // Pipeline layout creation
+    VkPushConstantRange pushConstantRange = gh::pushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(IlluminationConstants));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+        gh::pipelineLayoutCreateInfo(
+            &descriptorSetLayout,
+            1);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    gb->createPipelineLayout(&pipelineLayoutInfo, nullptr, &lightPipelineLayout);
+
+    // Actual pipeline creation
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = gh::pipelineCreateInfo(lightPipelineLayout, lightRenderPass, 0);
+    pipelineCreateInfo.pVertexInputState = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState = &multisampleState;
+    pipelineCreateInfo.pViewportState = &viewportState;
+    pipelineCreateInfo.pDynamicState = &dynamicState;
+    pipelineCreateInfo.stageCount = shaderStages.size();
+    pipelineCreateInfo.pStages = shaderStages.data();
+
+    gb->createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &lightPipeline);
+
+    // Cleanup
+    gb->destroyShaderModule(vertShaderModule, nullptr);
+    gb->destroyShaderModule(fragShaderModule, nullptr);
+}
@@ -0,0 +1,146 @@
+#ifndef LIGHTING_RENDERER_H
+#define LIGHTING_RENDERER_H
+
+#include <array>
+#include <vector>
+#include <chrono>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui.h"
+#include "imgui_impl_vulkan.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+
+namespace uengine::graphics {
+
+    struct Light {
+        glm::vec2 position; // World space
+        glm::vec3 color;
+        float radius;       // World space
+        float intensity = 1.0f;
+    };
+
+    // Screen space copy of a light, as read by the illumination shader
+    struct LightData {
+        alignas(8) glm::vec2 position; // Pixels
+        alignas(4) float radius;       // Pixels
+        alignas(4) float intensity;
+        alignas(16) glm::vec4 color;
+    };
+
+    // 2D lighting in two offscreen passes:
+    //  - occlusion, occluder polygons are rasterized into a single channel mask
+    //  - illumination, a fullscreen pass adds every light touching the pixel's tile,
+    //    shadowed by marching the occlusion mask towards the light
+    // Lights are binned into screen tiles on the CPU each frame, a pixel only loops over
+    // the lights of its tile so the cost follows light coverage, not light count.
+    class LightingRenderer {
+        public:
+            static constexpr uint32_t TILE_SIZE = 16;           // Pixels, must match the illumination shader
+            static constexpr uint32_t MAX_LIGHTS_PER_TILE = 63; // Must match the illumination shader
+
+            LightingRenderer(GraphicsBase * gb, uint32_t maxLights);
+            ~LightingRenderer();
+
+            void resize(int32_t width, int32_t height);
+            void setViewProjection(glm::mat4 vp);
+            void setAmbient(glm::vec3 ambient);
+            void setShadowSteps(uint32_t steps);
+
+            void clearLights();
+            void addLight(const Light & light);
+
+            // Simple polygons in world space, triangulated once when added
+            void clearOccluders();
+            void addOccluder(const std::vector<glm::vec2> & polygon);
+
+            void render(VkCommandBuffer cb);
+
+            ImTextureID getTexture();        // Light map, for ImGui
+            ImVec2 getTextureUV();           // Bottom right UV of the rendered area within the light map
+            VkImageView getLightMapView();   // Light map, to be sampled by other passes up to getTextureUV()
+            VkSampler getSampler();
+
+            // Statistics of the last render
+            uint32_t getLightCount();
+            uint32_t getOccluderTriangleCount();
+            float getAverageLightsPerTile();
+            float getCullTime(); // Milliseconds spent binning lights
+
+            static void triangulate(const std::vector<glm::vec2> & polygon, std::vector<glm::vec2> & triangles);
+
+        private:
+            GraphicsBase * gb;
+
+            uint32_t maxLights;
+            glm::mat4 vp = glm::mat4(1.0f);
+            glm::vec3 ambient = glm::vec3(0.05f);
+            uint32_t shadowSteps = 24;
+
+            std::vector<Light> lights;
+            std::vector<glm::vec2> occluderVertices; // Triangle list
+            bool occludersChanged = false;
+
+            uint32_t lightCount = 0;
+            float averageLightsPerTile = 0.0f;
+            float cullTime = 0.0f;
+
+            struct Offscreen {
+                int32_t width = 0, height = 0; // Rendered area, targets are allocated with slack
+                uint32_t tilesX = 0, tilesY = 0;
+                OffscreenTarget occlusion;
+                OffscreenTarget light;
+                ImTextureID texture = nullptr;
+            } offscreen;
+
+            struct FrameResources {
+                VkBuffer lightBuffer;
+                VkDeviceMemory lightMemory;
+                LightData * lights;     // Persistently mapped
+                VkBuffer tileBuffer = VK_NULL_HANDLE;
+                VkDeviceMemory tileMemory;
+                uint32_t * tiles;       // Per tile, a count followed by MAX_LIGHTS_PER_TILE light indices
+                VkDescriptorSet descriptorSet;
+            };
+            std::vector<FrameResources> frames;
+
+            VkBuffer occluderBuffer = VK_NULL_HANDLE;
+            VkDeviceMemory occluderMemory;
+
+            struct IlluminationConstants {
+                alignas(16) glm::vec4 ambient;
+                alignas(8) glm::vec2 targetSize;
+                alignas(4) uint32_t tilesX;
+                alignas(4) uint32_t shadowSteps;
+            };
+
+            VkSampler sampler;
+            VkRenderPass occlusionRenderPass;
+            VkRenderPass lightRenderPass;
+            VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+            VkDescriptorSetLayout descriptorSetLayout;
+            VkPipelineLayout occlusionPipelineLayout;
+            VkPipeline occlusionPipeline;
+            VkPipelineLayout lightPipelineLayout;
+            VkPipeline lightPipeline;
+
+            void cullLights(FrameResources & frame);
+            void uploadOccluders();
+
+            void setupSampler();
+            void setupLightBuffers();
+            void setupOffscreen(int32_t width, int32_t height);
+            void destroyOffscreen();
+            void setupDescriptorSetLayout();
+            void setupDescriptorSets();
+            void setupOcclusionPipeline();
+            void setupLightPipeline();
+    };
+
+}
+
+#endif
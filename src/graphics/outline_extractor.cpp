@@ -0,0 +1,342 @@
+#include "outline_extractor.h"
+
+using namespace uengine::graphics;
+
+// Boundary edge directions, clockwise in texture space (y down)
+enum Direction { RIGHT, DOWN, LEFT, UP };
+static const glm::ivec2 steps[4] = { {1, 0}, {0, 1}, {-1, 0}, {0, -1} };
+
+static float segmentDistance(glm::vec2 p, glm::vec2 a, glm::vec2 b) {
+    glm::vec2 ab = b - a;
+    float length2 = glm::dot(ab, ab);
+    float t = length2 > 0.0f ? glm::clamp(glm::dot(p - a, ab) / length2, 0.0f, 1.0f) : 0.0f;
+    return glm::length(p - (a + t * ab));
+}
+
+OutlineExtractor::OutlineExtractor(OutlineSettings settings_) {
+    settings = settings_;
+}
+
+/*
+ *  External methods
+ */
+
+std::vector<Outline> * OutlineExtractor::getOutlines(Sprite * sprite, Frame * frame) {
+    if (!frame->hasOutlines())
+        extract(sprite, frame);
+    return frame->getOutlines();
+}
+
+Outline * OutlineExtractor::getHull(Sprite * sprite, Frame * frame) {
+    if (!frame->hasHull())
+        extract(sprite, frame);
+    return frame->getHull();
+}
+
+void OutlineExtractor::extract(Sprite * sprite, Frame * frame) {
+    if (!sprite->hasPixels())
+        throw std::runtime_error("failed to extract outlines, sprite texture was loaded without its pixels!");
+
+    glm::ivec2 origin, size;
+    getFrameArea(sprite, frame, origin, size);
+    frame->setOutlines(extract(sprite->getPixel(0, 0), sprite->getWidth(), origin, size));
+    frame->setHull(extractHull(sprite->getPixel(0, 0), sprite->getWidth(), origin, size));
+}
+
+uint32_t OutlineExtractor::extractSprite(Sprite * sprite, bool force, uint32_t threads) {
+    std::vector<Frame *> frames;
+    for (auto & [skinName, skin] : *sprite->getSkins())
+        for (auto & [animationName, animation] : *skin->getAnimations())
+            for (auto frame : *animation->getFrames())
+                if (force || !frame->hasOutlines() || !frame->hasHull())
+                    frames.push_back(frame);
+
+    if (frames.empty())
+        return 0;
+
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min<uint32_t>(threads, frames.size());
+
+    // Frames are independent and only read the shared pixels, workers pull them one by one
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < frames.size(); i = next++)
+            extract(sprite, frames[i]);
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threads; i++)
+        workers.emplace_back(worker);
+    worker();
+    for (auto & thread : workers)
+        thread.join();
+
+    return frames.size();
+}
+
+std::vector<Outline> OutlineExtractor::extract(const uint8_t * pixels, int stride, glm::ivec2 origin, glm::ivec2 size) {
+    std::vector<Outline> result;
+    int w = size.x, h = size.y;
+    if (w <= 0 || h <= 0)
+        return result;
+
+    // Solid mask with a one pixel empty border, no bound checks while looking at neighbours
+    int maskStride = w + 2;
+    std::vector<uint8_t> mask(maskStride * (h + 2), 0);
+    for (int y = 0; y < h; y++) {
+        const uint8_t * row = pixels + ((size_t) (origin.y + y) * stride + origin.x) * 4;
+        for (int x = 0; x < w; x++)
+            mask[(y + 1) * maskStride + x + 1] = row[x * 4 + 3] >= settings.alphaThreshold;
+    }
+
+    // Directed boundary edges between pixel corners, solid on the right hand side.
+    // Each corner holds a bit per outgoing direction, saddles have two.
+    int cornerStride = w + 1;
+    std::vector<uint8_t> edges(cornerStride * (h + 1), 0);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const uint8_t * m = &mask[(y + 1) * maskStride + x + 1];
+            if (!m[0])
+                continue;
+            if (!m[-maskStride])
+                edges[y * cornerStride + x] |= 1 << RIGHT;
+            if (!m[1])
+                edges[y * cornerStride + x + 1] |= 1 << DOWN;
+            if (!m[maskStride])
+                edges[(y + 1) * cornerStride + x + 1] |= 1 << LEFT;
+            if (!m[-1])
+                edges[(y + 1) * cornerStride + x] |= 1 << UP;
+        }
+    }
+
+    const int offsets[4] = { 1, cornerStride, -1, -cornerStride };
+
+    for (int start = 0; start < (int) edges.size(); start++) {
+        while (edges[start]) {
+            // Follow the edges back to the start, keeping corners only
+            std::vector<glm::vec2> loop;
+            int corner = start;
+            int direction = -1;
+            do {
+                uint8_t bits = edges[corner];
+                int next;
+                // At a saddle stay around the same pixel, diagonal neighbours are not connected
+                if (direction >= 0 && (bits & (1 << ((direction + 1) % 4))))
+                    next = (direction + 1) % 4;
+                else
+                    for (next = 0; !(bits & (1 << next)); next++);
+
+                if (next != direction)
+                    loop.push_back(glm::vec2(corner % cornerStride, corner / cornerStride));
+
+                edges[corner] &= ~(1 << next);
+                direction = next;
+                corner += offsets[next];
+            } while (corner != start);
+
+            // Clockwise loops in y down space are outer boundaries, holes go the other way
+            if (area(loop) < settings.minArea)
+                continue;
+
+            Outline outline = simplify(loop);
+            if (outline.size() < 3)
+                continue;
+
+            for (auto & point : outline)
+                point /= glm::vec2(size);
+            result.push_back(outline);
+        }
+    }
+
+    return result;
+}
+
+Outline OutlineExtractor::extractHull(const uint8_t * pixels, int stride, glm::ivec2 origin, glm::ivec2 size) {
+    float w = (float) size.x, h = (float) size.y;
+    Outline quad = { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
+
+    // Outer corners of the first and last solid pixel of each row, the hull of those covers every pixel
+    std::vector<glm::vec2> points;
+    for (int y = 0; y < size.y; y++) {
+        const uint8_t * row = pixels + ((size_t) (origin.y + y) * stride + origin.x) * 4;
+        int first = 0, last = size.x - 1;
+        while (first < size.x && row[first * 4 + 3] < settings.alphaThreshold)
+            first++;
+        if (first == size.x)
+            continue;
+        while (row[last * 4 + 3] < settings.alphaThreshold)
+            last--;
+
+        points.push_back(glm::vec2(first, y));
+        points.push_back(glm::vec2(first, y + 1));
+        points.push_back(glm::vec2(last + 1, y));
+        points.push_back(glm::vec2(last + 1, y + 1));
+    }
+
+    // Blank frame, nothing to draw
+    if (points.empty())
+        return Outline();
+
+    // Monotone chain
+    std::sort(points.begin(), points.end(), [](const glm::vec2 & a, const glm::vec2 & b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    auto cross = [](glm::vec2 o, glm::vec2 a, glm::vec2 b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    };
+
+    Outline hull(2 * points.size());
+    size_t k = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) >= 0.0f)
+            k--;
+        hull[k++] = points[i];
+    }
+    for (size_t i = points.size() - 1, lower = k + 1; i > 0; i--) {
+        while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i - 1]) >= 0.0f)
+            k--;
+        hull[k++] = points[i - 1];
+    }
+    hull.resize(k - 1);
+    // Clockwise in y down space, like outlines
+    std::reverse(hull.begin(), hull.end());
+
+    // Down to the budget: repeatedly drop the edge whose neighbours, once extended to meet,
+    // add the least area. The new corner has to stay inside the frame or the uvs would
+    // sample the neighbouring frames.
+    uint32_t maxVertices = std::max<uint32_t>(settings.maxHullVertices, 4);
+    while (hull.size() > maxVertices) {
+        size_t n = hull.size();
+        size_t best = n;
+        float bestArea = 0.0f;
+        glm::vec2 bestCorner;
+
+        for (size_t i = 0; i < n; i++) {
+            glm::vec2 a = hull[(i + n - 1) % n], b = hull[i], c = hull[(i + 1) % n], d = hull[(i + 2) % n];
+            glm::vec2 u = b - a, v = c - d;
+            float denominator = u.x * v.y - u.y * v.x;
+            if (std::abs(denominator) < 1e-6f)
+                continue;
+
+            // b + t u = c + s v, both rays have to go forward
+            glm::vec2 bc = c - b;
+            float t = (bc.x * v.y - bc.y * v.x) / denominator;
+            float s = (bc.x * u.y - bc.y * u.x) / denominator;
+            if (t <= 0.0f || s <= 0.0f)
+                continue;
+
+            glm::vec2 corner = b + t * u;
+            if (corner.x < -1e-3f || corner.y < -1e-3f || corner.x > w + 1e-3f || corner.y > h + 1e-3f)
+                continue;
+
+            float added = std::abs(cross(b, corner, c)) * 0.5f;
+            if (best == n || added < bestArea) {
+                best = i;
+                bestArea = added;
+                bestCorner = glm::clamp(corner, glm::vec2(0.0f), glm::vec2(w, h));
+            }
+        }
+
+        if (best == n)
+            return quad;
+
+        hull[best] = bestCorner;
+        hull.erase(hull.begin() + (best + 1) % n);
+    }
+
+    // Not worth the extra triangles when it barely beats the quad
+    if (area(hull) > 0.9f * w * h)
+        return quad;
+
+    for (auto & point : hull)
+        point /= glm::vec2(w, h);
+    return hull;
+}
+
+float OutlineExtractor::area(const Outline & polygon) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        const glm::vec2 & a = polygon[i];
+        const glm::vec2 & b = polygon[(i + 1) % polygon.size()];
+        sum += a.x * b.y - b.x * a.y;
+    }
+    return sum * 0.5f;
+}
+
+/*
+ *  Internal methods
+ */
+
+void OutlineExtractor::getFrameArea(Sprite * sprite, Frame * frame, glm::ivec2 & origin, glm::ivec2 & size) {
+    // Frame area in whole pixels, clamped to the texture
+    FrameData * data = frame->getData();
+    glm::ivec2 textureSize(sprite->getWidth(), sprite->getHeight());
+    glm::ivec2 lower = glm::clamp(glm::ivec2(glm::round(data->uvPos)), glm::ivec2(0), textureSize);
+    glm::ivec2 upper = glm::clamp(glm::ivec2(glm::round(data->uvPos + data->uvSize)), lower, textureSize);
+
+    origin = lower;
+    size = upper - lower;
+}
+
+Outline OutlineExtractor::simplify(const std::vector<glm::vec2> & loop) {
+    size_t n = loop.size();
+    if (n <= 3 || settings.maxVertices < 3)
+        return n <= 3 ? loop : Outline();
+
+    // Closed Douglas-Peucker, seeded with the first point and the one farthest from it.
+    // Segments are refined by largest deviation first, so the budget goes where it matters.
+    size_t farthest = 0;
+    for (size_t i = 1; i < n; i++)
+        if (glm::length(loop[i] - loop[0]) > glm::length(loop[farthest] - loop[0]))
+            farthest = i;
+
+    struct Segment {
+        size_t begin, end; // Indices in the loop, end may wrap
+        size_t split;
+        float deviation;
+        bool operator<(const Segment & other) const { return deviation < other.deviation; }
+    };
+
+    auto measure = [&](size_t begin, size_t end) {
+        Segment segment = {begin, end, begin, 0.0f};
+        for (size_t i = (begin + 1) % n; i != end; i = (i + 1) % n) {
+            float deviation = segmentDistance(loop[i], loop[begin], loop[end]);
+            if (deviation > segment.deviation) {
+                segment.deviation = deviation;
+                segment.split = i;
+            }
+        }
+        return segment;
+    };
+
+    std::vector<bool> kept(n, false);
+    kept[0] = true;
+    kept[farthest] = true;
+    uint32_t count = 2;
+
+    std::priority_queue<Segment> segments;
+    segments.push(measure(0, farthest));
+    segments.push(measure(farthest, 0));
+
+    while (!segments.empty() && count < settings.maxVertices) {
+        Segment segment = segments.top();
+        segments.pop();
+        // A polygon needs a third point, whatever its deviation
+        if (segment.deviation <= settings.tolerance && count >= 3)
+            break;
+        if (segment.split == segment.begin)
+            continue;
+
+        kept[segment.split] = true;
+        count++;
+        segments.push(measure(segment.begin, segment.split));
+        segments.push(measure(segment.split, segment.end));
+    }
+
+    Outline outline;
+    for (size_t i = 0; i < n; i++)
+        if (kept[i])
+            outline.push_back(loop[i]);
+    return outline;
+}
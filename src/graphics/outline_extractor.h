@@ -0,0 +1,64 @@
+#ifndef OUTLINE_EXTRACTOR_H
+#define OUTLINE_EXTRACTOR_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "sprite.h"
+
+namespace uengine::graphics {
+
+    struct OutlineSettings {
+        uint8_t alphaThreshold = 128; // Pixels at or above are solid
+        uint32_t maxVertices = 16;    // Per outline
+        float tolerance = 1.0f;       // Pixels, simplification stops below this deviation
+        float minArea = 4.0f;         // Pixels, smaller islands are dropped
+        uint32_t maxHullVertices = 8; // At least 4, the full quad is always a valid hull
+    };
+
+    // Builds outline polygons of sprite frames from their alpha channel: boundaries are traced
+    // along pixel edges (marching squares without interpolation), then simplified with
+    // Douglas-Peucker down to the vertex budget. Only outer boundaries are kept, holes are
+    // filled, which is what occluders and collision shapes want.
+    // Hulls are convex polygons covering every solid pixel, meant to be drawn instead of the
+    // frame quad so fully transparent pixels are not rasterized.
+    // The sprite texture must have been loaded with keepData.
+    class OutlineExtractor {
+        public:
+            OutlineExtractor(OutlineSettings settings = OutlineSettings());
+
+            // Outlines of the frame, extracted on the first call and cached on the frame
+            std::vector<Outline> * getOutlines(Sprite * sprite, Frame * frame);
+
+            Outline * getHull(Sprite * sprite, Frame * frame);
+
+            // Extracts and caches the outlines and the hull of one frame
+            void extract(Sprite * sprite, Frame * frame);
+
+            // Every frame of the sprite, spread over threads (0 uses every hardware thread).
+            // Without force, frames with valid cached shapes are skipped. Returns the number
+            // of frames extracted.
+            uint32_t extractSprite(Sprite * sprite, bool force = false, uint32_t threads = 0);
+
+            // Thread safe, pixels are RGBA8 rows of stride pixels, the area is in pixels
+            std::vector<Outline> extract(const uint8_t * pixels, int stride, glm::ivec2 origin, glm::ivec2 size);
+            Outline extractHull(const uint8_t * pixels, int stride, glm::ivec2 origin, glm::ivec2 size);
+
+            static float area(const Outline & polygon); // Positive for clockwise polygons in y down space
+
+        private:
+            OutlineSettings settings;
+
+            Outline simplify(const std::vector<glm::vec2> & loop);
+            void getFrameArea(Sprite * sprite, Frame * frame, glm::ivec2 & origin, glm::ivec2 & size);
+    };
+
+}
+
+#endif
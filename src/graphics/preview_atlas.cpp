@@ -0,0 +1,396 @@
+// imgui_draw.cpp keeps its copy of stb_rect_pack static, this file gets its own
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "preview_atlas.h"
+
+using namespace uengine::graphics;
+using GraphicsBase = uengine::graphics::GraphicsBase;
+namespace gh = uengine::graphics::helper;
+
+PreviewAtlas::PreviewAtlas(GraphicsBase * gb_, int32_t width, int32_t height) {
+    gb = gb_;
+
+    gb->createOffscreenRenderPass(VK_FORMAT_R8G8B8A8_UNORM, &renderPass);
+    setupOffscreen(width, height);
+    setupPipeline();
+    repack(width, height);
+}
+
+PreviewAtlas::~PreviewAtlas() {
+    clear();
+    destroyOffscreen();
+    gb->destroyPipeline(pipeline, nullptr);
+    gb->destroyPipelineLayout(pipelineLayout, nullptr);
+    gb->destroyRenderPass(renderPass, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+int PreviewAtlas::add(Sprite * sprite, int32_t width, int32_t height) {
+    int id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = thumbnails.size();
+        thumbnails.push_back({});
+    }
+
+    Thumbnail & thumbnail = thumbnails[id];
+    thumbnail.spriteBox = new SpriteBox(sprite);
+    thumbnail.width = width;
+    thumbnail.height = height;
+    thumbnailCount++;
+
+    // Removed slots are only reclaimed by a repack, try that before growing the image
+    if (!pack(thumbnail)) {
+        int32_t atlasWidth = offscreen.width;
+        int32_t atlasHeight = offscreen.height;
+        if (!fit(atlasWidth, atlasHeight)) {
+            // Full even at the largest size, the new thumbnail is dropped and the others go back
+            // to the current image, unless that repack no longer fits them
+            remove(id);
+            id = -1;
+            atlasWidth = offscreen.width;
+            atlasHeight = offscreen.height;
+            fit(atlasWidth, atlasHeight);
+        }
+
+        // Frames still in flight keep reading the previous image until it is destroyed
+        if (atlasWidth != offscreen.width || atlasHeight != offscreen.height) {
+            destroyOffscreen();
+            setupOffscreen(atlasWidth, atlasHeight);
+        }
+    }
+
+    dirty = true;
+    return id;
+}
+
+void PreviewAtlas::remove(int id) {
+    delete thumbnails[id].spriteBox;
+    thumbnails[id] = {};
+    freeIds.push_back(id);
+    thumbnailCount--;
+    dirty = true;
+}
+
+void PreviewAtlas::clear() {
+    for (auto & thumbnail : thumbnails)
+        delete thumbnail.spriteBox;
+    thumbnails.clear();
+    freeIds.clear();
+    thumbnailCount = 0;
+    repack(offscreen.width, offscreen.height);
+    dirty = true;
+}
+
+SpriteBox * PreviewAtlas::getSpriteBox(int id) {
+    return thumbnails[id].spriteBox;
+}
+
+uint32_t PreviewAtlas::getThumbnailCount() {
+    return thumbnailCount;
+}
+
+ImTextureID PreviewAtlas::getTexture() {
+    return offscreen.texture;
+}
+
+void PreviewAtlas::getUV(int id, ImVec2 & uv0, ImVec2 & uv1) {
+    Thumbnail & thumbnail = thumbnails[id];
+    uv0 = ImVec2((float) thumbnail.x / offscreen.width, (float) thumbnail.y / offscreen.height);
+    uv1 = ImVec2((float) (thumbnail.x + thumbnail.width) / offscreen.width, (float) (thumbnail.y + thumbnail.height) / offscreen.height);
+}
+
+void PreviewAtlas::setBackgroundColor(float color_[4]) {
+    if (std::equal(color_, color_ + 4, color))
+        return;
+    std::copy(color_, color_ + 4, color);
+    dirty = true;
+}
+
+void PreviewAtlas::update() {
+    std::chrono::time_point<std::chrono::high_resolution_clock> time = std::chrono::high_resolution_clock::now();
+    float dt = ((std::chrono::duration<float>) (time - lastTime)).count();
+    lastTime = time;
+
+    for (auto & thumbnail : thumbnails)
+        if (thumbnail.spriteBox)
+            thumbnail.spriteBox->update(dt);
+}
+
+void PreviewAtlas::render(VkCommandBuffer cb) {
+    if (thumbnailCount == 0)
+        return;
+
+    // Paused animations and single frames leave the instances unchanged, the image still holds them
+    buildInstances();
+    if (!dirty && instances.size() == renderedInstances.size()
+            && memcmp(instances.data(), renderedInstances.data(), instances.size() * sizeof(ThumbnailInstance)) == 0)
+        return;
+    renderedInstances = instances;
+    dirty = false;
+
+    void * data;
+    VkDeviceSize offset = gb->allocateDynamic(instances.size() * sizeof(ThumbnailInstance), &data);
+    memcpy(data, instances.data(), instances.size() * sizeof(ThumbnailInstance));
+
+    VkClearValue clearValues = {0};
+    std::copy(color, color + 4, clearValues.color.float32);
+
+    VkRenderPassBeginInfo renderPassBeginInfo = gh::renderPassBeginInfo();
+    renderPassBeginInfo.renderPass = renderPass;
+    renderPassBeginInfo.framebuffer = offscreen.frameBuffer;
+    renderPassBeginInfo.renderArea.extent.width = offscreen.width;
+    renderPassBeginInfo.renderArea.extent.height = offscreen.height;
+    renderPassBeginInfo.clearValueCount = 1;
+    renderPassBeginInfo.pClearValues = &clearValues;
+
+    vkCmdBeginRenderPass(cb, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport = gh::viewport((float) offscreen.width, (float) offscreen.height, 0.0f, 1.0f);
+    vkCmdSetViewport(cb, 0, 1, &viewport);
+
+    VkRect2D scissor = gh::rect2D(offscreen.width, offscreen.height, 0, 0);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    VkDescriptorSet textureTable = gb->getTextureTable();
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &textureTable, 0, nullptr);
+    VkBuffer buffer = gb->getDynamicBuffer();
+    vkCmdBindVertexBuffers(cb, 0, 1, &buffer, &offset);
+
+    // Without bindless textures the index has to be uniform within a draw, thumbnails of one
+    // sprite share their texture so this stays a single draw
+    bool bindless = gb->hasBindlessTextures();
+    uint32_t runStart = 0;
+    for (uint32_t i = 0; i < instances.size(); i++) {
+        bool last = i + 1 == instances.size();
+        if (last || (!bindless && instances[i + 1].textureId != instances[i].textureId)) {
+            vkCmdDraw(cb, 6, i + 1 - runStart, 0, runStart);
+            runStart = i + 1;
+        }
+    }
+
+    vkCmdEndRenderPass(cb);
+}
+
+/*
+ *  Internal methods
+ */
+
+bool PreviewAtlas::pack(Thumbnail & thumbnail) {
+    stbrp_rect rect = {};
+    rect.w = thumbnail.width + 2 * PADDING;
+    rect.h = thumbnail.height + 2 * PADDING;
+    stbrp_pack_rects(&packer, &rect, 1);
+
+    if (!rect.was_packed)
+        return false;
+    thumbnail.x = rect.x + PADDING;
+    thumbnail.y = rect.y + PADDING;
+    return true;
+}
+
+bool PreviewAtlas::repack(int32_t width, int32_t height) {
+    // Packing everything at once lets stb_rect_pack sort by height, slots usually end up tighter
+    packerNodes.resize(width);
+    stbrp_init_target(&packer, width, height, packerNodes.data(), packerNodes.size());
+
+    std::vector<stbrp_rect> rects;
+    for (size_t i = 0; i < thumbnails.size(); i++) {
+        if (!thumbnails[i].spriteBox)
+            continue;
+        stbrp_rect rect = {};
+        rect.id = i;
+        rect.w = thumbnails[i].width + 2 * PADDING;
+        rect.h = thumbnails[i].height + 2 * PADDING;
+        rects.push_back(rect);
+    }
+    if (rects.empty())
+        return true;
+
+    bool packed = stbrp_pack_rects(&packer, rects.data(), rects.size());
+    for (auto & rect : rects) {
+        thumbnails[rect.id].x = rect.x + PADDING;
+        thumbnails[rect.id].y = rect.y + PADDING;
+    }
+    return packed;
+}
+
+bool PreviewAtlas::fit(int32_t & width, int32_t & height) {
+    while (!repack(width, height)) {
+        if (width >= MAX_SIZE && height >= MAX_SIZE)
+            return false;
+        if (width <= height)
+            width = std::min(width * 2, MAX_SIZE);
+        else
+            height = std::min(height * 2, MAX_SIZE);
+    }
+    return true;
+}
+
+void PreviewAtlas::buildInstances() {
+    instances.clear();
+    glm::vec2 atlasSize((float) offscreen.width, (float) offscreen.height);
+
+    // Grouped by texture, an atlas usually holds the thumbnails of a single sprite
+    for (auto & thumbnail : thumbnails) {
+        if (!thumbnail.spriteBox)
+            continue;
+
+        SpriteBoxData * data = thumbnail.spriteBox->getData();
+        glm::vec2 halfSize = glm::vec2((float) thumbnail.width, (float) thumbnail.height) / atlasSize;
+        glm::vec2 center = glm::vec2((float) thumbnail.x, (float) thumbnail.y) / atlasSize * 2.0f - 1.0f + halfSize;
+
+        ThumbnailInstance instance;
+        instance.model = data->model;
+        instance.slot = glm::vec4(center, halfSize);
+        instance.uv = glm::vec4(data->uvPos, data->uvSize);
+        instance.tint = data->tint;
+        instance.textureId = data->textureId;
+        instances.push_back(instance);
+    }
+
+    std::stable_sort(instances.begin(), instances.end(), [](const ThumbnailInstance & a, const ThumbnailInstance & b) {
+        return a.textureId < b.textureId;
+    });
+}
+
+
+/*----------------- Offscreen -----------------*/
+
+void PreviewAtlas::setupOffscreen(int32_t width, int32_t height) {
+    gb->createOffscreenTarget(renderPass, VK_FORMAT_R8G8B8A8_UNORM, width, height, &offscreen);
+
+    offscreen.texture = ImGui_ImplVulkan_AddTexture(offscreen.sampler, offscreen.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    dirty = true;
+}
+
+void PreviewAtlas::destroyOffscreen() {
+    gb->removeTexture(offscreen.texture);
+    gb->destroyOffscreenTarget(&offscreen);
+    offscreen.texture = nullptr;
+}
+
+
+/*---------------- Pipeline -----------------*/
+
+void PreviewAtlas::setupPipeline() {
+    // Shaders, the bindless variant indexes the texture table with non-uniform indices
+    VkShaderModule vertShaderModule = gb->createShaderModule("res/shaders/preview_atlas/vert.spv");
+    VkShaderModule fragShaderModule = gb->createShaderModule(gb->hasBindlessTextures()
+        ? "res/shaders/preview_atlas/frag_bindless.spv"
+        : "res/shaders/preview_atlas/frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+    shaderStages[0] = gh::pipelineShaderStageCreateInfo(vertShaderModule, VK_SHADER_STAGE_VERTEX_BIT);
+    shaderStages[1] = gh::pipelineShaderStageCreateInfo(fragShaderModule, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Vertex input, the corners are picked in the shader and thumbnails are per instance attributes
+    VkPipelineVertexInputStateCreateInfo vertexInputState = gh::pipelineVertexInputStateCreateInfo();
+
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions = {
+        gh::vertexInputBindingDescription(0, sizeof(ThumbnailInstance), VK_VERTEX_INPUT_RATE_INSTANCE)
+    };
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = {
+        gh::vertexInputAttributeDescription(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ThumbnailInstance, model)),
+        gh::vertexInputAttributeDescription(0, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ThumbnailInstance, model) + sizeof(glm::vec4)),
+        gh::vertexInputAttributeDescription(0, 2, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ThumbnailInstance, model) + 2 * sizeof(glm::vec4)),
+        gh::vertexInputAttributeDescription(0, 3, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ThumbnailInstance, model) + 3 * sizeof(glm::vec4)),
+        gh::vertexInputAttributeDescription(0, 4, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ThumbnailInstance, slot)),
+        gh::vertexInputAttributeDescription(0, 5, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ThumbnailInstance, uv)),
+        gh::vertexInputAttributeDescription(0, 6, VK_FORMAT_R32G32B32_SFLOAT, offsetof(ThumbnailInstance, tint)),
+        gh::vertexInputAttributeDescription(0, 7, VK_FORMAT_R32_SINT, offsetof(ThumbnailInstance, textureId)),
+    };
+
+    vertexInputState.vertexBindingDescriptionCount = bindingDescriptions.size();
+    vertexInputState.pVertexBindingDescriptions = bindingDescriptions.data();
+    vertexInputState.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInputState.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState =
+        gh::pipelineInputAssemblyStateCreateInfo(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            0,
+            VK_FALSE);
+
+    // Viewport
+    VkPipelineViewportStateCreateInfo viewportState = gh::pipelineViewportStateCreateInfo(1, 1, 0);
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizationState =
+        gh::pipelineRasterizationStateCreateInfo(
+            VK_POLYGON_MODE_FILL,
+            VK_CULL_MODE_NONE,
+            VK_FRONT_FACE_CLOCKWISE,
+            0);
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampleState =
+        gh::pipelineMultisampleStateCreateInfo(
+            VK_SAMPLE_COUNT_1_BIT,
+            0);
+
+    // Color blend attachment
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState =
+        gh::pipelineColorBlendAttachmentState(
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+            VK_TRUE);
+    colorBlendAttachmentState.blendEnable = VK_TRUE;
+    colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_MAX;
+
+    // Color blend state
+    VkPipelineColorBlendStateCreateInfo colorBlendState =
+        gh::pipelineColorBlendStateCreateInfo(
+            1,
+            &colorBlendAttachmentState);
+
+    // Dynamic state
+    std::vector<VkDynamicState> dynamicStateEnables = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState =
+        gh::pipelineDynamicStateCreateInfo(
+            dynamicStateEnables.data(),
+            dynamicStateEnables.size(),
+            0);
+
+    // Pipeline layout creation, the only set is the global texture table
+    VkDescriptorSetLayout textureTableLayout = gb->getTextureTableLayout();
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+        gh::pipelineLayoutCreateInfo(
+            &textureTableLayout,
+            1);
+
+    gb->createPipelineLayout(&pipelineLayoutInfo, nullptr, &pipelineLayout);
+
+    // Actual pipeline creation
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = gh::pipelineCreateInfo(pipelineLayout, renderPass, 0);
+    pipelineCreateInfo.pVertexInputState = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState = &multisampleState;
+    pipelineCreateInfo.pViewportState = &viewportState;
+    pipelineCreateInfo.pDynamicState = &dynamicState;
+    pipelineCreateInfo.stageCount = shaderStages.size();
+    pipelineCreateInfo.pStages = shaderStages.data();
+
+    gb->createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+
+    // Cleanup
+    gb->destroyShaderModule(vertShaderModule, nullptr);
+    gb->destroyShaderModule(fragShaderModule, nullptr);
+}
@@ -0,0 +1,100 @@
+#ifndef PREVIEW_ATLAS_H
+#define PREVIEW_ATLAS_H
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui.h"
+#include "imgui_impl_vulkan.h"
+#include "imstb_rectpack.h"
+#include "sprite.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+
+namespace uengine::graphics {
+
+    // Animation thumbnails packed in a single offscreen image. Each thumbnail is a slot of the
+    // atlas found with stb_rect_pack, all of them are drawn in one render pass with one instanced
+    // draw, and ImGui shows them through the UVs of their slot.
+    // Adding or removing a thumbnail creates no Vulkan object, the atlas doubles its image and
+    // repacks the live slots only when a new one no longer fits.
+    class PreviewAtlas {
+        public:
+            PreviewAtlas(GraphicsBase * gb, int32_t width, int32_t height);
+            ~PreviewAtlas();
+
+            int add(Sprite * sprite, int32_t width, int32_t height); // Returns the thumbnail id, -1 when the atlas is full
+            void remove(int id);
+            void clear();
+            SpriteBox * getSpriteBox(int id);
+            uint32_t getThumbnailCount();
+
+            ImTextureID getTexture();
+            void getUV(int id, ImVec2 & uv0, ImVec2 & uv1);
+            void setBackgroundColor(float color[4]);
+
+            void update(); // Advances every animation
+            void render(VkCommandBuffer cb);
+
+        private:
+            GraphicsBase * gb;
+
+            static constexpr int32_t MAX_SIZE = 4096;
+            static constexpr int32_t PADDING = 1; // Empty border around slots, keeps filtering inside them
+
+            struct Thumbnail {
+                SpriteBox * spriteBox = nullptr; // Null for a free id
+                int32_t x = 0, y = 0;            // Slot in the image, padding excluded
+                int32_t width = 0, height = 0;
+            };
+            std::vector<Thumbnail> thumbnails;
+            std::vector<int> freeIds;
+            uint32_t thumbnailCount = 0;
+
+            stbrp_context packer;
+            std::vector<stbrp_node> packerNodes;
+
+            float color[4] = {0, 0, 0, 0};
+            std::chrono::time_point<std::chrono::high_resolution_clock> lastTime = std::chrono::high_resolution_clock::now();
+
+            // Per instance vertex input, read from the frame's dynamic memory
+            struct ThumbnailInstance {
+                glm::mat4 model;   // Sprite box model, in the slot's own normalized coordinates
+                glm::vec4 slot;    // Center and half size of the slot in the atlas normalized coordinates
+                glm::vec4 uv;      // Position and size in the sprite texture
+                glm::vec3 tint;
+                int32_t textureId; // Index in the global texture table
+            };
+            std::vector<ThumbnailInstance> instances;
+            std::vector<ThumbnailInstance> renderedInstances; // As of the last pass, the image is kept while they match
+            bool dirty = true;
+
+            VkRenderPass renderPass;
+            VkPipelineLayout pipelineLayout;
+            VkPipeline pipeline;
+
+            struct Offscreen : OffscreenTarget {
+                ImTextureID texture = nullptr;
+            } offscreen;
+
+            bool pack(Thumbnail & thumbnail);
+            bool repack(int32_t width, int32_t height); // False when some thumbnail did not fit
+            bool fit(int32_t & width, int32_t & height); // Repacks, growing the size up to MAX_SIZE until everything fits
+            void buildInstances();
+
+            void setupOffscreen(int32_t width, int32_t height);
+            void destroyOffscreen();
+            void setupPipeline();
+    };
+
+}
+
+#endif
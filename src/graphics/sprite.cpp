@@ -4,6 +4,23 @@ namespace fs = std::experimental::filesystem;
 using namespace rapidxml;
 using namespace uengine::graphics;
 
+// Path of target as seen from the base directory, experimental filesystem has no relative()
+static fs::path relativePath(fs::path target, fs::path base) {
+    target = fs::exists(target) ? fs::canonical(target) : fs::absolute(target);
+    base = fs::exists(base) ? fs::canonical(base) : fs::absolute(base);
+
+    auto t = target.begin(), b = base.begin();
+    for (; t != target.end() && b != base.end() && *t == *b; t++, b++);
+
+    fs::path result;
+    for (; b != base.end(); b++)
+        if (*b != ".")
+            result /= "..";
+    for (; t != target.end(); t++)
+        result /= *t;
+    return result;
+}
+
 /* Frame */
 Frame::Frame(): frameData() {
 }
@@ -28,6 +45,30 @@ void Frame::loadXML(xml_node<> * frameNode) {
     frameData.size.y = std::stof(frameNode->first_attribute("sy")->value());
     frameData.size.z = 1.0;
     frameData.dt = std::stof(frameNode->first_attribute("dt")->value());
+
+    // Cached shapes, "x,y x,y ..." per polygon
+    auto parsePoints = [](xml_node<> * node) {
+        Outline outline;
+        std::istringstream points(node->first_attribute("points")->value());
+        glm::vec2 point;
+        char separator;
+        while (points >> point.x >> separator >> point.y)
+            outline.push_back(point);
+        return outline;
+    };
+
+    clearOutlines();
+    xml_node<> * outlinesNode = frameNode->first_node("outlines");
+    if (outlinesNode) {
+        std::vector<Outline> loaded;
+        for (xml_node<> * outlineNode = outlinesNode->first_node("outline"); outlineNode; outlineNode = outlineNode->next_sibling("outline"))
+            loaded.push_back(parsePoints(outlineNode));
+        setOutlines(loaded);
+    }
+
+    xml_node<> * hullNode = frameNode->first_node("hull");
+    if (hullNode)
+        setHull(parsePoints(hullNode));
 }
 
 xml_node<> * Frame::saveXML(xml_document<> * doc) {
@@ -42,10 +83,78 @@ xml_node<> * Frame::saveXML(xml_document<> * doc) {
     frameNode->append_attribute(doc->allocate_attribute("dx", doc->allocate_string(std::to_string(frameData.offset[0]).c_str())));
     frameNode->append_attribute(doc->allocate_attribute("dy", doc->allocate_string(std::to_string(frameData.offset[1]).c_str())));
     frameNode->append_attribute(doc->allocate_attribute("dt", doc->allocate_string(std::to_string(frameData.dt).c_str())));
+
+    auto pointsNode = [doc](const char * name, const Outline & outline) {
+        std::string points;
+        for (auto & point : outline)
+            points += (points.empty() ? "" : " ") + std::to_string(point.x) + "," + std::to_string(point.y);
+
+        xml_node<> * node = doc->allocate_node(node_element, name);
+        node->append_attribute(doc->allocate_attribute("points", doc->allocate_string(points.c_str())));
+        return node;
+    };
+
+    if (hasOutlines()) {
+        xml_node<> * outlinesNode = doc->allocate_node(node_element, "outlines");
+        for (auto & outline : outlines)
+            outlinesNode->append_node(pointsNode("outline", outline));
+        frameNode->append_node(outlinesNode);
+    }
+
+    if (hasHull())
+        frameNode->append_node(pointsNode("hull", hull));
     
     return frameNode;
 }
 
+bool Frame::hasOutlines() {
+    return outlinesValid && isShapeAreaCurrent();
+}
+
+std::vector<Outline> * Frame::getOutlines() {
+    return &outlines;
+}
+
+void Frame::setOutlines(std::vector<Outline> outlines_) {
+    setShapeArea();
+    outlines = outlines_;
+    outlinesValid = true;
+}
+
+void Frame::clearOutlines() {
+    outlines.clear();
+    outlinesValid = false;
+    hull.clear();
+    hullValid = false;
+}
+
+bool Frame::hasHull() {
+    return hullValid && isShapeAreaCurrent();
+}
+
+Outline * Frame::getHull() {
+    return &hull;
+}
+
+void Frame::setHull(Outline hull_) {
+    setShapeArea();
+    hull = hull_;
+    hullValid = true;
+}
+
+bool Frame::isShapeAreaCurrent() {
+    return shapeArea == glm::vec4(frameData.uvPos, frameData.uvSize);
+}
+
+void Frame::setShapeArea() {
+    // Shapes of a previous texture area are stale
+    if (!isShapeAreaCurrent()) {
+        outlinesValid = false;
+        hullValid = false;
+        shapeArea = glm::vec4(frameData.uvPos, frameData.uvSize);
+    }
+}
+
 
 /* Animation */
 
@@ -197,6 +306,7 @@ Sprite::~Sprite() {
     }
     
     if (textureLoaded) {
+        gb->unregisterTexture(textureId);
         gb->deleteTextureImage(&textureImage, &textureImageMemory, &textureImageView, &textureSampler, data);
     }
 }
@@ -238,7 +348,9 @@ void Sprite::save(std::string filename) {
 
     xml_node<> * node = doc.allocate_node(node_element, "sprite");
     node->append_attribute(doc.allocate_attribute("name", name.c_str()));
-    node->append_attribute(doc.allocate_attribute("image", textureFilename.c_str()));
+    // The image path is resolved from the sprite file directory on load
+    std::string image = relativePath(textureFilename, fs::absolute(filename).parent_path()).generic_string();
+    node->append_attribute(doc.allocate_attribute("image", image.c_str()));
 
     for (auto& [key, skin] : skins)
         node->append_node(skin->saveXML(&doc));
@@ -265,6 +377,10 @@ VkSampler Sprite::getSampler() {
     return textureSampler;
 }
 
+uint32_t Sprite::getTextureId() {
+    return textureId;
+}
+
 int Sprite::getWidth() {
     return w;
 }
@@ -277,6 +393,23 @@ uint8_t * Sprite::getPixel(int x, int y) {
     return data + (x + y * w) * 4;
 }
 
+bool Sprite::hasPixels() {
+    return data != nullptr;
+}
+
+void Sprite::buildAlphaIndex() {
+    if (data && !alphaIndex.isBuilt())
+        alphaIndex.build(data, w, h);
+}
+
+bool Sprite::hasAlphaIndex() {
+    return alphaIndex.isBuilt();
+}
+
+AlphaIndex * Sprite::getAlphaIndex() {
+    return &alphaIndex;
+}
+
 std::string Sprite::toString() {
     std::string res = "Sprite [" + name + "]:\n";
 
@@ -310,6 +443,7 @@ void Sprite::setTextureFilename(std::string textureFilename_) {
 
 void Sprite::loadTexture(bool keepData) {
     gb->createTextureImage(textureFilename, &textureImage, &textureImageMemory, &textureImageView, &textureSampler, &data, &w, &h, keepData);
+    textureId = gb->registerTexture(textureImageView, textureSampler);
     textureLoaded = true;
 }
 
@@ -318,7 +452,12 @@ bool Sprite::isTextureLoaded() {
 }
 
 void Sprite::freeTexture() {
+    gb->unregisterTexture(textureId);
+    textureId = 0;
     gb->deleteTextureImage(&textureImage, &textureImageMemory, &textureImageView, &textureSampler, data);
+    data = nullptr;
+    alphaIndex.clear();
+    textureLoaded = false;
 }
 
 void Sprite::addSkin(Skin * skin) {
@@ -391,12 +530,71 @@ int SpriteBox::getFrameId() {
     return frameId;
 }
 
+float SpriteBox::getAnimationTime() {
+    if (!animation)
+        return 0.0f;
+
+    float time = frameTime;
+    for (int i = 0; i < frameId; i++)
+        time += animation->getFrame(i)->getData()->dt;
+    return time;
+}
+
+glm::vec3 SpriteBox::getPosition() {
+    return position;
+}
+
+glm::vec3 SpriteBox::getSize() {
+    return size;
+}
+
+glm::vec3 SpriteBox::getTint() {
+    return glm::make_vec3(tint);
+}
+
+void SpriteBox::getBounds(glm::vec2 & lower, glm::vec2 & upper) {
+    lower = glm::vec2(position);
+    upper = glm::vec2(position);
+
+    // Unit quad spans [-1, 1] before scaling, as in getData
+    auto addFrame = [&](Frame * frame) {
+        FrameData * data = frame->getData();
+        glm::vec2 center = glm::vec2(position + data->offset);
+        glm::vec2 extent = glm::abs(glm::vec2(size * data->size));
+        lower = glm::min(lower, center - extent);
+        upper = glm::max(upper, center + extent);
+    };
+
+    if (animation && animation->getNbFrames() > 0) {
+        lower = glm::vec2(std::numeric_limits<float>::max());
+        upper = glm::vec2(std::numeric_limits<float>::lowest());
+        for (auto frame : *animation->getFrames())
+            addFrame(frame);
+    } else if (frame) {
+        addFrame(frame);
+    }
+
+    // The rotation is around the world origin
+    if (angle != 0.0f) {
+        glm::mat2 rotation(std::cos(angle), std::sin(angle), -std::sin(angle), std::cos(angle));
+        glm::vec2 corners[4] = { lower, glm::vec2(upper.x, lower.y), upper, glm::vec2(lower.x, upper.y) };
+        lower = glm::vec2(std::numeric_limits<float>::max());
+        upper = glm::vec2(std::numeric_limits<float>::lowest());
+        for (auto & corner : corners) {
+            glm::vec2 rotated = rotation * corner;
+            lower = glm::min(lower, rotated);
+            upper = glm::max(upper, rotated);
+        }
+    }
+}
+
 SpriteBoxData * SpriteBox::getData() {
     FrameData * data = frame->getData();
     spriteBoxData.model = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 0.0f, 1.0f)) * glm::translate(glm::mat4(1.0f), position + data->offset) * glm::scale(glm::mat4(1.0f), size * data->size);
     spriteBoxData.tint = glm::make_vec3(tint);
     spriteBoxData.uvPos = data->uvPos / glm::vec2((float) sprite->getWidth(), (float) sprite->getHeight());
     spriteBoxData.uvSize = data->uvSize / glm::vec2((float) sprite->getWidth(), (float) sprite->getHeight());
+    spriteBoxData.textureId = textureId >= 0 ? textureId : static_cast<int>(sprite->getTextureId());
 
     return &spriteBoxData;
 }
@@ -5,10 +5,12 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <limits>
 #include <chrono>
 #include <string>
 #include <fstream>
 #include <streambuf>
+#include <sstream>
 #include <experimental/filesystem>
 
 #include <vulkan/vulkan.h>
@@ -22,6 +24,7 @@
 #include "rapidxml_ext.h"
 
 #include "graphics_base.h"
+#include "alpha_index.h"
 
 
 namespace uengine::graphics {
@@ -34,6 +37,9 @@ namespace uengine::graphics {
         float dt;         // Frame duration
     };
 
+    // Closed polygon, normalized to the frame: (0, 0) is the uvPos corner, (1, 1) the opposite one
+    typedef std::vector<glm::vec2> Outline;
+
     class Frame {
         public:
             Frame();
@@ -41,9 +47,29 @@ namespace uengine::graphics {
             void setData(FrameData frameData);
             void loadXML(rapidxml::xml_node<> * frameNode);
             rapidxml::xml_node<> * saveXML(rapidxml::xml_document<> * doc);
+
+            // Shapes cached for the frame's current texture area, see OutlineExtractor.
+            // Both are invalid once the texture area has changed.
+            bool hasOutlines();
+            std::vector<Outline> * getOutlines();
+            void setOutlines(std::vector<Outline> outlines);
+            void clearOutlines(); // The hull too
+
+            bool hasHull();
+            Outline * getHull(); // Convex, covers every solid pixel, empty for a blank frame
+            void setHull(Outline hull);
                 
         private:
             FrameData frameData;
+
+            glm::vec4 shapeArea = glm::vec4(-1.0f); // uvPos and uvSize the shapes were extracted from
+            bool outlinesValid = false;
+            std::vector<Outline> outlines;
+            bool hullValid = false;
+            Outline hull;
+
+            bool isShapeAreaCurrent();
+            void setShapeArea();
     };
 
     class Animation {
@@ -99,10 +125,16 @@ namespace uengine::graphics {
             
             VkImageView getImageView();
             VkSampler getSampler();
+            uint32_t getTextureId(); // Index in the global texture table, 0 until the texture is loaded
 
             int getWidth();
             int getHeight();
             uint8_t * getPixel(int x, int y);
+            bool hasPixels(); // Only when the texture was loaded with keepData
+            // The index takes 4 bytes per pixel, it is only built on request, by callers running many queries
+            void buildAlphaIndex(); // Nothing without pixels
+            bool hasAlphaIndex();
+            AlphaIndex * getAlphaIndex(); // Empty until built
             std::string toString();
 
             void setTextureFilename(std::string textureFilename);
@@ -125,7 +157,9 @@ namespace uengine::graphics {
             VkImage textureImage;
             VkImageView textureImageView;
             VkSampler textureSampler;
-            uint8_t * data;
+            uint32_t textureId = 0;
+            uint8_t * data = nullptr;
+            AlphaIndex alphaIndex;
             int w;
             int h;
 
@@ -139,6 +173,7 @@ namespace uengine::graphics {
         alignas(8) glm::vec2 uvPos;
         alignas(8) glm::vec2 uvSize;
         alignas(4) int textureId;
+        alignas(4) int meshId = 0; // Index in a SpriteMeshTable, 0 is the full quad
     };
 
     class SpriteBox {
@@ -146,12 +181,18 @@ namespace uengine::graphics {
             SpriteBox(Sprite * sprite);
             ~SpriteBox();
 
-            void setTextureId(int textureId);
+            void setTextureId(int textureId); // Overrides the sprite texture, -1 uses it again
             Sprite * getSprite();
             Skin * getSkin();
             Animation * getAnimation();
             Frame * getFrame();
             int getFrameId();
+            float getAnimationTime(); // Time elapsed since the first frame of the animation
+            glm::vec3 getPosition();
+            glm::vec3 getSize();
+            glm::vec3 getTint();
+            // World AABB of every frame of the animation, stays valid while the animation plays
+            void getBounds(glm::vec2 & lower, glm::vec2 & upper);
             SpriteBoxData * getData();
 
             void setSkin(Skin * skin);
@@ -168,7 +209,7 @@ namespace uengine::graphics {
             void mimic(SpriteBox * other);
 
         private:
-            int textureId;
+            int textureId = -1;
             Sprite * sprite = nullptr;
             Skin * skin = nullptr;
             Animation * animation = nullptr;
@@ -0,0 +1,208 @@
+#include "sprite_animation_table.h"
+
+using namespace uengine::graphics;
+using GraphicsBase = uengine::graphics::GraphicsBase;
+namespace gh = uengine::graphics::helper;
+
+SpriteAnimationTable::SpriteAnimationTable(GraphicsBase * gb_, Sprite * sprite_) {
+    gb = gb_;
+    sprite = sprite_;
+
+    setupDescriptorSetLayout();
+    buildTables();
+    setupBuffers();
+    setupDescriptorPool();
+    setupDescriptorSet();
+}
+
+SpriteAnimationTable::~SpriteAnimationTable() {
+    destroyResources();
+    gb->destroyDescriptorSetLayout(descriptorSetLayout, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void SpriteAnimationTable::rebuild() {
+    // Frames still in flight keep reading the previous buffers and set
+    destroyResources();
+    buildTables();
+    setupBuffers();
+    setupDescriptorPool();
+    setupDescriptorSet();
+}
+
+Sprite * SpriteAnimationTable::getSprite() {
+    return sprite;
+}
+
+int SpriteAnimationTable::getAnimationIndex(Animation * animation) {
+    auto it = animationIndices.find(animation);
+    if (it == animationIndices.end())
+        return -1;
+    return it->second;
+}
+
+float SpriteAnimationTable::getDuration(Animation * animation) {
+    int index = getAnimationIndex(animation);
+    if (index < 0)
+        return 0.0f;
+    return entries[index].duration;
+}
+
+uint32_t SpriteAnimationTable::getFrameCount() {
+    return frames.size();
+}
+
+VkDescriptorSetLayout SpriteAnimationTable::getDescriptorSetLayout() {
+    return descriptorSetLayout;
+}
+
+VkDescriptorSet SpriteAnimationTable::getDescriptorSet() {
+    return descriptorSet;
+}
+
+/*
+ *  Internal methods
+ */
+
+void SpriteAnimationTable::buildTables() {
+    animationIndices.clear();
+    entries.clear();
+    frames.clear();
+
+    glm::vec2 textureSize((float) sprite->getWidth(), (float) sprite->getHeight());
+
+    for (auto & [skinName, skin] : *sprite->getSkins()) {
+        for (auto & [animationName, animation] : *skin->getAnimations()) {
+            if (animation->getNbFrames() == 0)
+                continue;
+
+            AnimationTableEntry entry = {};
+            entry.firstFrame = frames.size();
+            entry.frameCount = animation->getNbFrames();
+
+            // Same frame boundaries as SpriteBox::update, a frame lasts its dt
+            float time = 0.0f;
+            for (auto frame : *animation->getFrames()) {
+                FrameData * data = frame->getData();
+                time += data->dt;
+
+                AnimationTableFrame tableFrame;
+                tableFrame.uv = glm::vec4(data->uvPos / textureSize, data->uvSize / textureSize);
+                tableFrame.offset = glm::vec4(data->offset, time);
+                tableFrame.size = glm::vec4(data->size, 0.0f);
+                frames.push_back(tableFrame);
+            }
+            entry.duration = std::max(time, 1e-6f);
+
+            animationIndices[animation] = entries.size();
+            entries.push_back(entry);
+        }
+    }
+}
+
+
+/*----------------- Buffers ----------------*/
+
+void SpriteAnimationTable::setupBuffers() {
+    // Storage buffers can't be empty, a sprite without frames still gets one element
+    VkDeviceSize entrySize = std::max<size_t>(entries.size(), 1) * sizeof(AnimationTableEntry);
+    VkDeviceSize frameSize = std::max<size_t>(frames.size(), 1) * sizeof(AnimationTableFrame);
+
+    gb->createBuffer(
+        entrySize,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        entryBuffer,
+        entryMemory);
+
+    gb->createBuffer(
+        frameSize,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frameBuffer,
+        frameMemory);
+
+    // Written once, the tables only change on rebuild
+    void * data;
+    gb->mapMemory(entryMemory, 0, entrySize, 0, &data);
+        memcpy(data, entries.data(), entries.size() * sizeof(AnimationTableEntry));
+    gb->unmapMemory(entryMemory);
+
+    gb->mapMemory(frameMemory, 0, frameSize, 0, &data);
+        memcpy(data, frames.data(), frames.size() * sizeof(AnimationTableFrame));
+    gb->unmapMemory(frameMemory);
+}
+
+
+/*----------------- Descriptors ----------------*/
+
+void SpriteAnimationTable::setupDescriptorPool() {
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2)
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo =
+        gh::descriptorPoolCreateInfo(
+            poolSizes.size(),
+            poolSizes.data(),
+            1);
+
+    gb->createDescriptorPool(&descriptorPoolInfo, nullptr, &descriptorPool);
+}
+
+void SpriteAnimationTable::setupDescriptorSetLayout() {
+    std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings = {
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0),
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            1)
+    };
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayoutInfo =
+        gh::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    gb->createDescriptorSetLayout(&descriptorLayoutInfo, nullptr, &descriptorSetLayout);
+}
+
+void SpriteAnimationTable::setupDescriptorSet() {
+    VkDescriptorSetAllocateInfo allocInfo =
+        gh::descriptorSetAllocateInfo(
+            descriptorPool,
+            &descriptorSetLayout,
+            1);
+
+    gb->allocateDescriptorSets(&allocInfo, &descriptorSet);
+
+    VkDescriptorBufferInfo entryBufferInfo = gh::descriptorBufferInfo(entryBuffer, 0, VK_WHOLE_SIZE);
+    VkDescriptorBufferInfo frameBufferInfo = gh::descriptorBufferInfo(frameBuffer, 0, VK_WHOLE_SIZE);
+
+    std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+        gh::writeDescriptorSet(
+            descriptorSet,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            0,
+            &entryBufferInfo),
+        gh::writeDescriptorSet(
+            descriptorSet,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            1,
+            &frameBufferInfo)
+    };
+
+    gb->updateDescriptorSets(static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+}
+
+void SpriteAnimationTable::destroyResources() {
+    // Destroying the pool frees the set
+    gb->destroyDescriptorPool(descriptorPool, nullptr);
+    gb->destroyBuffer(entryBuffer, nullptr);
+    gb->freeMemory(entryMemory, nullptr);
+    gb->destroyBuffer(frameBuffer, nullptr);
+    gb->freeMemory(frameMemory, nullptr);
+}
@@ -0,0 +1,76 @@
+#ifndef SPRITE_ANIMATION_TABLE_H
+#define SPRITE_ANIMATION_TABLE_H
+
+#include <vector>
+#include <map>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "sprite.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+
+namespace uengine::graphics {
+
+    // GPU copy of a frame, uvs are normalized to the texture
+    struct AnimationTableFrame {
+        alignas(16) glm::vec4 uv;     // xy position, zw size
+        alignas(16) glm::vec4 offset; // xyz offset, w time at which the frame ends since the animation start
+        alignas(16) glm::vec4 size;   // xyz size
+    };
+
+    struct AnimationTableEntry {
+        alignas(4) uint32_t firstFrame;
+        alignas(4) uint32_t frameCount;
+        alignas(4) float duration;
+        alignas(4) uint32_t padding;
+    };
+
+    // Frame tables of every animation of a sprite, uploaded once in storage buffers (set binding 0
+    // for the entries, binding 1 for the frames) so shaders can find the current frame themselves.
+    // Editing frames requires a rebuild, the previous buffers are released once no frame uses them.
+    class SpriteAnimationTable {
+        public:
+            SpriteAnimationTable(GraphicsBase * gb, Sprite * sprite);
+            ~SpriteAnimationTable();
+
+            void rebuild();
+
+            Sprite * getSprite();
+            int getAnimationIndex(Animation * animation); // -1 for animations without frames
+            float getDuration(Animation * animation);
+            uint32_t getFrameCount();
+
+            VkDescriptorSetLayout getDescriptorSetLayout();
+            VkDescriptorSet getDescriptorSet();
+
+        private:
+            GraphicsBase * gb;
+            Sprite * sprite;
+
+            std::map<Animation *, uint32_t> animationIndices;
+            std::vector<AnimationTableEntry> entries;
+            std::vector<AnimationTableFrame> frames;
+
+            VkBuffer entryBuffer;
+            VkDeviceMemory entryMemory;
+            VkBuffer frameBuffer;
+            VkDeviceMemory frameMemory;
+
+            VkDescriptorPool descriptorPool;
+            VkDescriptorSetLayout descriptorSetLayout;
+            VkDescriptorSet descriptorSet;
+
+            void buildTables();
+            void setupBuffers();
+            void setupDescriptorPool();
+            void setupDescriptorSetLayout();
+            void setupDescriptorSet();
+            void destroyResources();
+    };
+
+}
+
+#endif
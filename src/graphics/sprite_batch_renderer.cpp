@@ -0,0 +1,335 @@
+#include "sprite_batch_renderer.h"
+
+using namespace uengine::graphics;
+using GraphicsBase = uengine::graphics::GraphicsBase;
+namespace gh = uengine::graphics::helper;
+
+SpriteBatchRenderer::SpriteBatchRenderer(GraphicsBase * gb_, VkRenderPass * renderPass_, uint32_t maxInstances_, SpriteMeshTable * meshTable_) {
+    gb = gb_;
+    renderPass = renderPass_;
+    meshTable = meshTable_;
+    maxInstances = maxInstances_;
+
+    setupDescriptorPool();
+    setupBuffers();
+    setupDescriptorSetLayouts();
+    setupDescriptorSets();
+    setupPipeline();
+}
+
+SpriteBatchRenderer::~SpriteBatchRenderer() {
+    for (auto & frame : frames) {
+        gb->unmapMemory(frame.memory);
+        gb->destroyBuffer(frame.buffer, nullptr);
+        gb->freeMemory(frame.memory, nullptr);
+    }
+    gb->destroyPipeline(pipeline, nullptr);
+    gb->destroyPipelineLayout(pipelineLayout, nullptr);
+    gb->destroyDescriptorSetLayout(instanceSetLayout, nullptr);
+    gb->destroyDescriptorPool(descriptorPool, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void SpriteBatchRenderer::setViewProjection(glm::mat4 vp_) {
+    vp = vp_;
+}
+
+void SpriteBatchRenderer::clear() {
+    // Keep the vectors around, their capacity is reused next frame
+    for (auto & batch : batches)
+        batch.second.clear();
+    sortedInstances.clear();
+    sortKeys.clear();
+    instanceCount = 0;
+}
+
+void SpriteBatchRenderer::add(SpriteBox * spriteBox) {
+    if (!spriteBox->getFrame())
+        return;
+    if (!meshTable) {
+        add(*spriteBox->getData());
+        return;
+    }
+    add(makeInstance(spriteBox));
+}
+
+void SpriteBatchRenderer::add(const SpriteBoxData & data) {
+    if (instanceCount >= maxInstances)
+        return;
+    batches[data.textureId].push_back(data);
+    instanceCount++;
+}
+
+void SpriteBatchRenderer::add(SpriteBox * spriteBox, uint64_t sortKey) {
+    if (!spriteBox->getFrame())
+        return;
+    add(makeInstance(spriteBox), sortKey);
+}
+
+void SpriteBatchRenderer::add(const SpriteBoxData & data, uint64_t sortKey) {
+    if (instanceCount >= maxInstances)
+        return;
+    sortedInstances.push_back(data);
+    sortKeys.push_back(sortKey);
+    instanceCount++;
+}
+
+uint32_t SpriteBatchRenderer::getInstanceCount() {
+    return instanceCount;
+}
+
+uint32_t SpriteBatchRenderer::getDrawCount() {
+    return drawCount;
+}
+
+void SpriteBatchRenderer::render(VkCommandBuffer cb) {
+    if (instanceCount == 0)
+        return;
+
+    // The frame slot has been waited on, its instance buffer is free to overwrite
+    FrameResources & frame = frames[gb->getCurrentFrame()];
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdPushConstants(cb, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &vp);
+    std::array<VkDescriptorSet, 3> sets = {frame.descriptorSet, gb->getTextureTable(), meshTable ? meshTable->getDescriptorSet() : VK_NULL_HANDLE};
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, meshTable ? 3 : 2, sets.data(), 0, nullptr);
+
+    uint32_t vertexCount = meshTable ? SpriteMeshTable::VERTICES_PER_INSTANCE : 6;
+
+    // Instances stay grouped by texture, without bindless the index has to be uniform within a draw
+    bool bindless = gb->hasBindlessTextures();
+    uint32_t firstInstance = 0;
+    drawCount = 0;
+    for (auto & [textureId, batch] : batches) {
+        if (batch.empty())
+            continue;
+
+        memcpy(frame.instances + firstInstance, batch.data(), batch.size() * sizeof(SpriteBoxData));
+        if (!bindless) {
+            vkCmdDraw(cb, vertexCount, static_cast<uint32_t>(batch.size()), 0, firstInstance);
+            drawCount++;
+        }
+
+        firstInstance += batch.size();
+    }
+
+    // Sorted instances, instances of a draw are blended in order so only texture changes split them
+    if (!sortedInstances.empty()) {
+        sorter.sort(sortKeys, sortOrder);
+
+        uint32_t runStart = firstInstance;
+        for (size_t i = 0; i < sortOrder.size(); i++) {
+            const SpriteBoxData & data = sortedInstances[sortOrder[i]];
+            frame.instances[firstInstance] = data;
+
+            if (!bindless && (i + 1 == sortOrder.size() || sortedInstances[sortOrder[i + 1]].textureId != data.textureId)) {
+                vkCmdDraw(cb, vertexCount, firstInstance + 1 - runStart, 0, runStart);
+                drawCount++;
+                runStart = firstInstance + 1;
+            }
+            firstInstance++;
+        }
+    }
+
+    if (bindless) {
+        vkCmdDraw(cb, vertexCount, instanceCount, 0, 0);
+        drawCount++;
+    }
+}
+
+SpriteBoxData SpriteBatchRenderer::makeInstance(SpriteBox * spriteBox) {
+    SpriteBoxData data = *spriteBox->getData();
+    if (meshTable)
+        data.meshId = meshTable->getMeshIndex(spriteBox->getFrame());
+    return data;
+}
+
+
+/*----------------- Descriptors ----------------*/
+
+void SpriteBatchRenderer::setupDescriptorPool() {
+    uint32_t framesInFlight = gb->getFramesInFlight();
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight)
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo =
+        gh::descriptorPoolCreateInfo(
+            poolSizes.size(),
+            poolSizes.data(),
+            framesInFlight);
+
+    gb->createDescriptorPool(&descriptorPoolInfo, nullptr, &descriptorPool);
+}
+
+void SpriteBatchRenderer::setupBuffers() {
+    frames.resize(gb->getFramesInFlight());
+
+    for (auto & frame : frames) {
+        gb->createBuffer(
+            maxInstances * sizeof(SpriteBoxData),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.buffer,
+            frame.memory);
+
+        void * data;
+        gb->mapMemory(frame.memory, 0, VK_WHOLE_SIZE, 0, &data);
+        frame.instances = (SpriteBoxData *) data;
+    }
+}
+
+void SpriteBatchRenderer::setupDescriptorSetLayouts() {
+    // Set 0: instances of the frame
+    VkDescriptorSetLayoutBinding instanceBinding =
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0);
+
+    VkDescriptorSetLayoutCreateInfo instanceLayoutInfo = gh::descriptorSetLayoutCreateInfo(&instanceBinding, 1);
+    gb->createDescriptorSetLayout(&instanceLayoutInfo, nullptr, &instanceSetLayout);
+
+    // Set 1 is the global texture table, owned by GraphicsBase, set 2 the optional mesh table
+}
+
+void SpriteBatchRenderer::setupDescriptorSets() {
+    for (auto & frame : frames) {
+        VkDescriptorSetAllocateInfo allocInfo =
+            gh::descriptorSetAllocateInfo(
+                descriptorPool,
+                &instanceSetLayout,
+                1);
+
+        gb->allocateDescriptorSets(&allocInfo, &frame.descriptorSet);
+
+        VkDescriptorBufferInfo bufferInfo =
+            gh::descriptorBufferInfo(
+                frame.buffer,
+                0,
+                maxInstances * sizeof(SpriteBoxData));
+
+        VkWriteDescriptorSet writeDescriptorSet =
+            gh::writeDescriptorSet(
+                frame.descriptorSet,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                0,
+                &bufferInfo);
+
+        gb->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+    }
+}
+
+
+/*---------------- Pipeline -----------------*/
+
+void SpriteBatchRenderer::setupPipeline() {
+    // Shaders
+    // The mesh variant reads the frame hull from the mesh table instead of the unit quad
+    VkShaderModule vertShaderModule = gb->createShaderModule(meshTable
+        ? "res/shaders/sprite_batch/vert_mesh.spv"
+        : "res/shaders/sprite_batch/vert.spv");
+    // The bindless variant indexes the texture table with non-uniform indices
+    VkShaderModule fragShaderModule = gb->createShaderModule(gb->hasBindlessTextures()
+        ? "res/shaders/sprite_batch/frag_bindless.spv"
+        : "res/shaders/sprite_batch/frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+    shaderStages[0] = gh::pipelineShaderStageCreateInfo(vertShaderModule, VK_SHADER_STAGE_VERTEX_BIT);
+    shaderStages[1] = gh::pipelineShaderStageCreateInfo(fragShaderModule, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Vertex input, the unit quad is hardcoded in the shader, meshes come from storage
+    VkPipelineVertexInputStateCreateInfo vertexInputState = gh::pipelineVertexInputStateCreateInfo();
+    vertexInputState.vertexBindingDescriptionCount = 0;
+    vertexInputState.vertexAttributeDescriptionCount = 0;
+
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState =
+        gh::pipelineInputAssemblyStateCreateInfo(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            0,
+            VK_FALSE);
+
+    // Viewport
+    VkPipelineViewportStateCreateInfo viewportState = gh::pipelineViewportStateCreateInfo(1, 1, 0);
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizationState =
+        gh::pipelineRasterizationStateCreateInfo(
+            VK_POLYGON_MODE_FILL,
+            VK_CULL_MODE_NONE,
+            VK_FRONT_FACE_CLOCKWISE,
+            0);
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampleState =
+        gh::pipelineMultisampleStateCreateInfo(
+            VK_SAMPLE_COUNT_1_BIT,
+            0);
+
+    // Color blend attachment
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState =
+        gh::pipelineColorBlendAttachmentState(
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+            VK_TRUE);
+    colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_MAX;
+
+    // Color blend state
+    VkPipelineColorBlendStateCreateInfo colorBlendState =
+        gh::pipelineColorBlendStateCreateInfo(
+            1,
+            &colorBlendAttachmentState);
+
+    // Dynamic state
+    std::vector<VkDynamicState> dynamicStateEnables = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState =
+        gh::pipelineDynamicStateCreateInfo(
+            dynamicStateEnables.data(),
+            dynamicStateEnables.size(),
+            0);
+
+    // Pipeline layout creation, view projection goes through push constants
+    std::vector<VkDescriptorSetLayout> setLayouts = {instanceSetLayout, gb->getTextureTableLayout()};
+    if (meshTable)
+        setLayouts.push_back(meshTable->getDescriptorSetLayout());
+    VkPushConstantRange pushConstantRange = gh::pushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+        gh::pipelineLayoutCreateInfo(
+            setLayouts.data(),
+            setLayouts.size());
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    gb->createPipelineLayout(&pipelineLayoutInfo, nullptr, &pipelineLayout);
+
+    // Actual pipeline creation
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = gh::pipelineCreateInfo(pipelineLayout, *renderPass, 0);
+    pipelineCreateInfo.pVertexInputState = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState = &multisampleState;
+    pipelineCreateInfo.pViewportState = &viewportState;
+    pipelineCreateInfo.pDynamicState = &dynamicState;
+    pipelineCreateInfo.stageCount = shaderStages.size();
+    pipelineCreateInfo.pStages = shaderStages.data();
+
+    gb->createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+
+    // Cleanup
+    gb->destroyShaderModule(vertShaderModule, nullptr);
+    gb->destroyShaderModule(fragShaderModule, nullptr);
+}
@@ -0,0 +1,86 @@
+#ifndef SPRITE_BATCH_RENDERER_H
+#define SPRITE_BATCH_RENDERER_H
+
+#include <array>
+#include <vector>
+#include <map>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "sprite.h"
+#include "sprite_mesh_table.h"
+#include "sprite_sort.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+
+namespace uengine::graphics {
+
+    // Draws any number of sprite boxes, instance data lives in a per-frame storage buffer
+    // and textures are picked from the global texture table by SpriteBoxData::textureId.
+    // With bindless textures everything is a single instanced draw, otherwise one per texture.
+    // With a mesh table, boxes are drawn as their frame's hull instead of the full quad.
+    // Instances added with a sort key (see SortKeyEncoder) are drawn after the others, in key
+    // order, consecutive instances sharing a texture go in the same draw.
+    class SpriteBatchRenderer {
+        public:
+            SpriteBatchRenderer(GraphicsBase * gb, VkRenderPass * renderPass, uint32_t maxInstances, SpriteMeshTable * meshTable = nullptr);
+            ~SpriteBatchRenderer();
+
+            void setViewProjection(glm::mat4 vp);
+
+            // Instances are collected between clear() and render()
+            void clear();
+            void add(SpriteBox * spriteBox);
+            void add(const SpriteBoxData & data);
+            void add(SpriteBox * spriteBox, uint64_t sortKey);
+            void add(const SpriteBoxData & data, uint64_t sortKey);
+            uint32_t getInstanceCount();
+            uint32_t getDrawCount(); // Draws recorded by the last render
+
+            void render(VkCommandBuffer cb);
+
+        private:
+            GraphicsBase * gb;
+            VkRenderPass * renderPass;
+            SpriteMeshTable * meshTable;
+
+            uint32_t maxInstances;
+            uint32_t instanceCount = 0;
+            glm::mat4 vp = glm::mat4(1.0f);
+
+            std::map<int, std::vector<SpriteBoxData>> batches; // Instances by texture id
+            std::vector<SpriteBoxData> sortedInstances;
+            std::vector<uint64_t> sortKeys;
+            std::vector<uint32_t> sortOrder;
+            RadixSorter sorter;
+            uint32_t drawCount = 0;
+
+            struct FrameResources {
+                VkBuffer buffer;
+                VkDeviceMemory memory;
+                SpriteBoxData * instances; // Persistently mapped
+                VkDescriptorSet descriptorSet;
+            };
+            std::vector<FrameResources> frames;
+
+            VkDescriptorPool descriptorPool;
+            VkDescriptorSetLayout instanceSetLayout;
+            VkPipelineLayout pipelineLayout;
+            VkPipeline pipeline;
+
+            SpriteBoxData makeInstance(SpriteBox * spriteBox);
+
+            void setupDescriptorPool();
+            void setupBuffers();
+            void setupDescriptorSetLayouts();
+            void setupDescriptorSets();
+            void setupPipeline();
+    };
+
+}
+
+#endif
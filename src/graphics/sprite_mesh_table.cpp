@@ -0,0 +1,179 @@
+#include "sprite_mesh_table.h"
+
+using namespace uengine::graphics;
+using GraphicsBase = uengine::graphics::GraphicsBase;
+namespace gh = uengine::graphics::helper;
+
+SpriteMeshTable::SpriteMeshTable(GraphicsBase * gb_, Sprite * sprite_, uint32_t maxVertices_) {
+    gb = gb_;
+    sprite = sprite_;
+    maxVertices = glm::clamp(maxVertices_, 4u, MAX_VERTICES);
+
+    setupDescriptorSetLayout();
+    buildTable();
+    setupBuffer();
+    setupDescriptorPool();
+    setupDescriptorSet();
+}
+
+SpriteMeshTable::~SpriteMeshTable() {
+    destroyResources();
+    gb->destroyDescriptorSetLayout(descriptorSetLayout, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void SpriteMeshTable::rebuild() {
+    // Frames still in flight keep reading the previous buffer and set
+    destroyResources();
+    buildTable();
+    setupBuffer();
+    setupDescriptorPool();
+    setupDescriptorSet();
+}
+
+Sprite * SpriteMeshTable::getSprite() {
+    return sprite;
+}
+
+int SpriteMeshTable::getMeshIndex(Frame * frame) {
+    auto it = meshIndices.find(frame);
+    if (it == meshIndices.end())
+        return 0;
+    return it->second;
+}
+
+uint32_t SpriteMeshTable::getMeshCount() {
+    return vertices.size() / MAX_VERTICES;
+}
+
+float SpriteMeshTable::getAreaRatio() {
+    return areaRatio;
+}
+
+VkDescriptorSetLayout SpriteMeshTable::getDescriptorSetLayout() {
+    return descriptorSetLayout;
+}
+
+VkDescriptorSet SpriteMeshTable::getDescriptorSet() {
+    return descriptorSet;
+}
+
+/*
+ *  Internal methods
+ */
+
+void SpriteMeshTable::buildTable() {
+    meshIndices.clear();
+    vertices.clear();
+
+    auto addMesh = [this](const Outline & hull) {
+        // Blank frames get a degenerate mesh, nothing is rasterized
+        for (uint32_t i = 0; i < MAX_VERTICES; i++)
+            vertices.push_back(hull.empty() ? glm::vec2(0.0f) : hull[std::min<size_t>(i, hull.size() - 1)]);
+    };
+
+    addMesh({ {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} });
+
+    OutlineSettings settings;
+    settings.maxHullVertices = maxVertices;
+    OutlineExtractor extractor(settings);
+
+    float areaSum = 0.0f;
+    for (auto & [skinName, skin] : *sprite->getSkins()) {
+        for (auto & [animationName, animation] : *skin->getAnimations()) {
+            for (auto frame : *animation->getFrames()) {
+                // Cached hulls may have been built with a larger budget
+                Outline * hull = extractor.getHull(sprite, frame);
+                if (hull->size() > maxVertices) {
+                    extractor.extract(sprite, frame);
+                    hull = frame->getHull();
+                }
+
+                meshIndices[frame] = getMeshCount();
+                addMesh(*hull);
+                areaSum += OutlineExtractor::area(*hull);
+            }
+        }
+    }
+
+    areaRatio = meshIndices.empty() ? 1.0f : areaSum / meshIndices.size();
+}
+
+
+/*----------------- Buffers ----------------*/
+
+void SpriteMeshTable::setupBuffer() {
+    VkDeviceSize size = vertices.size() * sizeof(glm::vec2);
+
+    gb->createBuffer(
+        size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        buffer,
+        memory);
+
+    // Written once, the table only changes on rebuild
+    void * data;
+    gb->mapMemory(memory, 0, size, 0, &data);
+        memcpy(data, vertices.data(), size);
+    gb->unmapMemory(memory);
+}
+
+
+/*----------------- Descriptors ----------------*/
+
+void SpriteMeshTable::setupDescriptorPool() {
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        gh::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1)
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo =
+        gh::descriptorPoolCreateInfo(
+            poolSizes.size(),
+            poolSizes.data(),
+            1);
+
+    gb->createDescriptorPool(&descriptorPoolInfo, nullptr, &descriptorPool);
+}
+
+void SpriteMeshTable::setupDescriptorSetLayout() {
+    VkDescriptorSetLayoutBinding setLayoutBinding =
+        gh::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0);
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayoutInfo = gh::descriptorSetLayoutCreateInfo(&setLayoutBinding, 1);
+    gb->createDescriptorSetLayout(&descriptorLayoutInfo, nullptr, &descriptorSetLayout);
+}
+
+void SpriteMeshTable::setupDescriptorSet() {
+    VkDescriptorSetAllocateInfo allocInfo =
+        gh::descriptorSetAllocateInfo(
+            descriptorPool,
+            &descriptorSetLayout,
+            1);
+
+    gb->allocateDescriptorSets(&allocInfo, &descriptorSet);
+
+    VkDescriptorBufferInfo bufferInfo = gh::descriptorBufferInfo(buffer, 0, VK_WHOLE_SIZE);
+
+    VkWriteDescriptorSet writeDescriptorSet =
+        gh::writeDescriptorSet(
+            descriptorSet,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            0,
+            &bufferInfo);
+
+    gb->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+}
+
+void SpriteMeshTable::destroyResources() {
+    // Destroying the pool frees the set
+    gb->destroyDescriptorPool(descriptorPool, nullptr);
+    gb->destroyBuffer(buffer, nullptr);
+    gb->freeMemory(memory, nullptr);
+}
@@ -0,0 +1,67 @@
+#ifndef SPRITE_MESH_TABLE_H
+#define SPRITE_MESH_TABLE_H
+
+#include <vector>
+#include <map>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "sprite.h"
+#include "outline_extractor.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+
+namespace uengine::graphics {
+
+    // Hull meshes of every frame of a sprite, uploaded once in a storage buffer (set binding 0)
+    // of MAX_VERTICES points per mesh, short hulls repeat their last point. Mesh 0 is the full
+    // quad. Hulls come from the frames' cache, missing ones are extracted, which requires the
+    // texture to be loaded with keepData.
+    // Editing frames requires a rebuild, the previous buffer is released once no frame uses it.
+    class SpriteMeshTable {
+        public:
+            static constexpr uint32_t MAX_VERTICES = 8; // Must match the mesh shaders
+            static constexpr uint32_t VERTICES_PER_INSTANCE = 3 * (MAX_VERTICES - 2); // Triangle fan as a list
+
+            SpriteMeshTable(GraphicsBase * gb, Sprite * sprite, uint32_t maxVertices = MAX_VERTICES);
+            ~SpriteMeshTable();
+
+            void rebuild();
+
+            Sprite * getSprite();
+            int getMeshIndex(Frame * frame); // 0 (the quad) for unknown frames
+            uint32_t getMeshCount();
+            float getAreaRatio(); // Average hull area over quad area, over every frame
+
+            VkDescriptorSetLayout getDescriptorSetLayout();
+            VkDescriptorSet getDescriptorSet();
+
+        private:
+            GraphicsBase * gb;
+            Sprite * sprite;
+            uint32_t maxVertices;
+
+            std::map<Frame *, uint32_t> meshIndices;
+            std::vector<glm::vec2> vertices;
+            float areaRatio = 1.0f;
+
+            VkBuffer buffer;
+            VkDeviceMemory memory;
+
+            VkDescriptorPool descriptorPool;
+            VkDescriptorSetLayout descriptorSetLayout;
+            VkDescriptorSet descriptorSet;
+
+            void buildTable();
+            void setupBuffer();
+            void setupDescriptorPool();
+            void setupDescriptorSetLayout();
+            void setupDescriptorSet();
+            void destroyResources();
+    };
+
+}
+
+#endif
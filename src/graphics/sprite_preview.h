@@ -41,28 +41,22 @@ namespace uengine::graphics {
         float color[4] = {0, 0, 0, 0};
         std::chrono::time_point<std::chrono::high_resolution_clock> lastTime = std::chrono::high_resolution_clock::now();
 
+        // The offscreen image is kept while the sprite box shows the same frame, paused previews cost nothing
+        uint64_t revision = 1; // View-projection and background color
+        uint64_t renderedRevision = 0;
+        SpriteBoxData renderedData;
+
         VkDescriptorPool descriptorPool;
         VkRenderPass renderPass;
 
-        struct Offscreen {
-            int32_t width=0, height=0;
-            VkDeviceMemory mem;
-            VkImage image;
-            VkImageView view;
-            VkFramebuffer frameBuffer;		
-            VkSampler sampler;
-            ImTextureID texture;
+        struct Offscreen : OffscreenTarget {
+            ImTextureID texture = nullptr;
         } offscreen;
 
         struct directVPData {
             alignas(16) glm::mat4 directVP;
         } directVPData;
 
-        VkBuffer directVPBuffer;
-        VkDeviceMemory directVPMemory;
-        VkBuffer spriteBoxBuffer;
-        VkDeviceMemory spriteBoxMemory;
-
         VkDescriptorSetLayout descriptorSetLayout;
         VkDescriptorSet descriptorSet;
         VkPipelineLayout pipelineLayout;
@@ -71,15 +65,11 @@ namespace uengine::graphics {
         // Descriptor pool
         void setupDescriptorPool();
         
-        // Render Pass
-        void setupRenderPass();
-
         // Offscreen methods
         void setupOffscreen(int32_t width, int32_t height);
         void destroyOffscreen();
 
         // Sprite
-        void setupBuffers();
         void setupDescriptorSetLayout();
         void setupDescriptorSet();
         void setupPipeline();
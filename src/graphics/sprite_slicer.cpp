@@ -0,0 +1,212 @@
+#include "sprite_slicer.h"
+
+using SpriteSlicer = uengine::graphics::SpriteSlicer;
+using SlicerSettings = uengine::graphics::SlicerSettings;
+using Slice = uengine::graphics::Slice;
+using AlphaScan = uengine::graphics::AlphaScan;
+
+SpriteSlicer::SpriteSlicer(SlicerSettings settings_, uint32_t threads_) {
+    settings = settings_;
+    threads = threads_ ? threads_ : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/*
+ *  External methods
+ */
+
+void SpriteSlicer::setSettings(SlicerSettings settings_) {
+    settings = settings_;
+}
+
+SlicerSettings SpriteSlicer::getSettings() {
+    return settings;
+}
+
+std::vector<Slice> SpriteSlicer::slice(const uint8_t * pixels, int stride, int x1, int y1, int x2, int y2) {
+    std::vector<Slice> slices;
+    int width = x2 - x1, height = y2 - y1;
+    if (width <= 0 || height <= 0)
+        return slices;
+
+    // Past the area size any distance bridges the same pixels, which keeps it in int range
+    int distance = (int) std::min<uint32_t>(settings.mergeDistance, std::max(width, height));
+
+    // Each band rescans distance rows above it, bands are kept tall enough for that to stay a fraction of their work
+    int bandHeight = std::max(MIN_BAND_HEIGHT, distance * BAND_DISTANCE_RATIO);
+    uint32_t bandCount = std::max(std::min<uint32_t>(threads, height / bandHeight), 1u);
+    std::vector<Band> bands(bandCount);
+    for (uint32_t i = 0; i < bandCount; i++) {
+        bands[i].y1 = (int64_t) height * i / bandCount;
+        bands[i].y2 = (int64_t) height * (i + 1) / bandCount;
+    }
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < bandCount; i++)
+        workers.emplace_back([&, i]() { labelBand(pixels, stride, x1, y1, width, distance, bands[i]); });
+    labelBand(pixels, stride, x1, y1, width, distance, bands[0]);
+    for (auto & worker : workers)
+        worker.join();
+
+    // One union-find over every run, the bands keep their roots and only the seams are united
+    std::vector<uint32_t> bases(bandCount + 1, 0);
+    for (uint32_t i = 0; i < bandCount; i++)
+        bases[i + 1] = bases[i] + bands[i].runs.size();
+
+    std::vector<uint32_t> parents(bases[bandCount]);
+    for (uint32_t i = 0; i < bandCount; i++)
+        for (size_t r = 0; r < bands[i].parents.size(); r++)
+            parents[bases[i] + r] = bases[i] + bands[i].parents[r];
+
+    for (uint32_t i = 1; i < bandCount; i++) {
+        Band & above = bands[i - 1], & below = bands[i];
+        uint32_t aboveFirst = above.rowStarts[above.rowStarts.size() - 2];
+        uint32_t belowEnd = below.rowStarts[1];
+        uniteRows(parents, above.runs.data() + aboveFirst, bases[i - 1] + aboveFirst, above.runs.size() - aboveFirst,
+                  below.runs.data(), bases[i], belowEnd);
+    }
+
+    // Frames gather the solid pixels of their runs, in the slot of their root
+    std::vector<Slice> frames(parents.size(), {width, height, 0, 0, 0});
+    for (uint32_t i = 0; i < bandCount; i++) {
+        Band & band = bands[i];
+        for (int y = band.y1; y < band.y2; y++) {
+            uint32_t row = y - band.y1;
+            for (uint32_t r = band.rowStarts[row]; r < band.rowStarts[row + 1]; r++) {
+                const Run & run = band.runs[r];
+                if (run.area == 0)
+                    continue;
+                Slice & frame = frames[find(parents, bases[i] + r)];
+                frame.x1 = std::min(frame.x1, run.solidX1);
+                frame.x2 = std::max(frame.x2, run.solidX2);
+                frame.y1 = std::min(frame.y1, y);
+                frame.y2 = std::max(frame.y2, y + 1);
+                frame.area += run.area;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < frames.size(); i++) {
+        Slice & frame = frames[i];
+        if (parents[i] != i || frame.area == 0 || frame.area < settings.minArea)
+            continue;
+        slices.push_back({x1 + frame.x1, y1 + frame.y1, x1 + frame.x2, y1 + frame.y2, frame.area});
+    }
+
+    sortReadingOrder(slices);
+    return slices;
+}
+
+/*
+ *  Internal methods
+ */
+
+void SpriteSlicer::labelBand(const uint8_t * pixels, int stride, int x1, int y1, int width, int distance, Band & band) {
+    band.runs.clear();
+    band.rowStarts.clear();
+    band.parents.clear();
+
+    // A dilated pixel has a solid one at most distance pixels to its left and above.
+    // lastRow keeps, per column, the last row with a horizontally dilated pixel.
+    std::vector<uint8_t> occupied, solid;
+    std::vector<int32_t> lastRow(width, INT32_MIN / 2);
+    int lastSolidRow = INT32_MIN / 2;
+
+    for (int y = std::max(band.y1 - distance, 0); y < band.y2; y++) {
+        const uint8_t * line = pixels + ((size_t) (y1 + y) * stride + x1) * 4;
+        AlphaScan::getOccupancy(line, stride, 0, 0, width, 1, occupied, solid, settings.alphaThreshold);
+
+        bool labelled = y >= band.y1;
+        if (labelled)
+            band.rowStarts.push_back(band.runs.size());
+
+        if (occupied[0]) {
+            lastSolidRow = y;
+            int lastX = INT32_MIN / 2;
+            for (int x = 0; x < width; x++) {
+                if (solid[x])
+                    lastX = x;
+                if (x - lastX <= distance)
+                    lastRow[x] = y;
+            }
+        }
+
+        // Nothing solid in reach, the dilated row is empty
+        if (!labelled || y - lastSolidRow > distance)
+            continue;
+
+        for (int x = 0; x < width;) {
+            if (y - lastRow[x] > distance) {
+                x++;
+                continue;
+            }
+            Run run = {x, x, width, 0, 0};
+            for (; x < width && y - lastRow[x] <= distance; x++) {
+                if (solid[x]) {
+                    run.solidX1 = std::min(run.solidX1, x);
+                    run.solidX2 = x + 1;
+                    run.area++;
+                }
+            }
+            run.x2 = x;
+            band.runs.push_back(run);
+        }
+
+        uint32_t row = y - band.y1;
+        uint32_t index = band.runs.size();
+        for (uint32_t r = band.rowStarts[row]; r < index; r++)
+            band.parents.push_back(r);
+        if (row > 0) {
+            uint32_t above = band.rowStarts[row - 1], current = band.rowStarts[row];
+            uniteRows(band.parents, band.runs.data() + above, above, current - above,
+                      band.runs.data() + current, current, index - current);
+        }
+    }
+    band.rowStarts.push_back(band.runs.size());
+}
+
+uint32_t SpriteSlicer::find(std::vector<uint32_t> & parents, uint32_t i) {
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]]; // Path halving
+        i = parents[i];
+    }
+    return i;
+}
+
+void SpriteSlicer::unite(std::vector<uint32_t> & parents, uint32_t a, uint32_t b) {
+    a = find(parents, a);
+    b = find(parents, b);
+    // The smaller index stays the root, labels do not depend on the order of the unions
+    if (a < b)
+        parents[b] = a;
+    else if (b < a)
+        parents[a] = b;
+}
+
+void SpriteSlicer::uniteRows(std::vector<uint32_t> & parents, const Run * above, uint32_t aboveBase, uint32_t aboveCount,
+                             const Run * below, uint32_t belowBase, uint32_t belowCount) {
+    // Both rows are sorted, runs touch when they overlap or meet diagonally
+    uint32_t a = 0, b = 0;
+    while (a < aboveCount && b < belowCount) {
+        if (above[a].x1 <= below[b].x2 && below[b].x1 <= above[a].x2)
+            unite(parents, aboveBase + a, belowBase + b);
+        if (above[a].x2 < below[b].x2)
+            a++;
+        else
+            b++;
+    }
+}
+
+void SpriteSlicer::sortReadingOrder(std::vector<Slice> & slices) {
+    // A frame starting above the bottom of the first frame of the current line joins that line
+    std::sort(slices.begin(), slices.end(), [](const Slice & a, const Slice & b) {
+        return a.y1 != b.y1 ? a.y1 < b.y1 : a.x1 < b.x1;
+    });
+
+    auto line = slices.begin();
+    while (line != slices.end()) {
+        int32_t bottom = line->y2;
+        auto end = std::find_if(line, slices.end(), [bottom](const Slice & s) { return s.y1 >= bottom; });
+        std::sort(line, end, [](const Slice & a, const Slice & b) { return a.x1 < b.x1; });
+        line = end;
+    }
+}
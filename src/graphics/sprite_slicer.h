@@ -0,0 +1,75 @@
+#ifndef SPRITE_SLICER_H
+#define SPRITE_SLICER_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+
+#include "alpha_scan.h"
+
+namespace uengine::graphics {
+
+    struct SlicerSettings {
+        uint8_t alphaThreshold = 1; // Pixels at or above are solid
+        uint32_t mergeDistance = 0; // Transparent pixels bridged between two solid ones, 0 is 8-connectivity
+        uint32_t minArea = 1;       // Solid pixels, smaller frames are dropped
+    };
+
+    // Tight rect of one frame, half open, in image pixels
+    struct Slice {
+        int32_t x1, y1, x2, y2;
+        uint32_t area; // Solid pixels
+    };
+
+    // Cuts a sprite sheet into frames, one per connected component of solid pixels.
+    // Solid pixels belong to the same frame when a chain of solid pixels links them with at
+    // most mergeDistance transparent pixels between consecutive ones (Chebyshev distance).
+    // The alpha mask is dilated by mergeDistance towards +x and +y, which connects exactly
+    // those pixels, then labelled as runs of pixels with a union-find:
+    //  - the rows are split in bands, each thread extracts and unites the runs of its band
+    //  - the bands are stitched along their seams, then frames gather the solid pixel bounds
+    // Frames come out in reading order, lines of frames top to bottom, each left to right.
+    class SpriteSlicer {
+        public:
+            SpriteSlicer(SlicerSettings settings = SlicerSettings(), uint32_t threads = 0); // 0 uses every hardware thread
+
+            void setSettings(SlicerSettings settings);
+            SlicerSettings getSettings();
+
+            // Thread safe, pixels are RGBA8 rows of stride pixels, the area must lie inside them
+            std::vector<Slice> slice(const uint8_t * pixels, int stride, int x1, int y1, int x2, int y2);
+
+        private:
+            static constexpr int MIN_BAND_HEIGHT = 64;
+            static constexpr int BAND_DISTANCE_RATIO = 4; // Minimum band height over the merge distance
+
+            SlicerSettings settings;
+            uint32_t threads;
+
+            // Horizontal run of dilated pixels, with the solid pixels it covers
+            struct Run {
+                int32_t x1, x2;           // Half open, area coordinates
+                int32_t solidX1, solidX2; // Bounds of the solid pixels, empty when solidX1 >= solidX2
+                uint32_t area;
+            };
+
+            struct Band {
+                int32_t y1, y2;                // Rows of the area
+                std::vector<Run> runs;
+                std::vector<uint32_t> rowStarts; // First run of each row, plus the end
+                std::vector<uint32_t> parents;   // Union-find over the band's runs
+            };
+
+            void labelBand(const uint8_t * pixels, int stride, int x1, int y1, int width, int distance, Band & band);
+
+            static uint32_t find(std::vector<uint32_t> & parents, uint32_t i);
+            static void unite(std::vector<uint32_t> & parents, uint32_t a, uint32_t b);
+            static void uniteRows(std::vector<uint32_t> & parents, const Run * above, uint32_t aboveBase, uint32_t aboveCount,
+                                  const Run * below, uint32_t belowBase, uint32_t belowCount);
+            static void sortReadingOrder(std::vector<Slice> & slices);
+    };
+
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include "sprite_sort.h"
+
+using namespace uengine::graphics;
+
+SortKeyEncoder::SortKeyEncoder(float backDepth_, float frontDepth_, uint32_t depthBits_) {
+    backDepth = backDepth_;
+    frontDepth = frontDepth_;
+    depthBits = std::clamp<uint32_t>(depthBits_, 1, 32);
+}
+
+/*
+ *  External methods
+ */
+
+uint64_t SortKeyEncoder::encode(uint32_t layer, float depth, uint32_t pipeline, uint32_t textureId) {
+    double t = frontDepth != backDepth ? ((double) depth - backDepth) / ((double) frontDepth - backDepth) : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    uint64_t quantized = (uint64_t) (t * (double) ((1ull << depthBits) - 1) + 0.5) << (32 - depthBits);
+
+    return ((uint64_t) (layer & 0xFF) << 56)
+        | (quantized << 24)
+        | ((uint64_t) (pipeline & 0xFF) << 16)
+        | (uint64_t) (textureId & 0xFFFF);
+}
+
+uint32_t SortKeyEncoder::getLayer(uint64_t key) {
+    return (key >> 56) & 0xFF;
+}
+
+uint32_t SortKeyEncoder::getPipeline(uint64_t key) {
+    return (key >> 16) & 0xFF;
+}
+
+uint32_t SortKeyEncoder::getTextureId(uint64_t key) {
+    return key & 0xFFFF;
+}
+
+
+RadixSorter::RadixSorter(uint32_t threads_) {
+    threads = threads_ ? threads_ : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+RadixSorter::~RadixSorter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto & worker : pool)
+        worker.join();
+}
+
+void RadixSorter::sort(const std::vector<uint64_t> & keys, std::vector<uint32_t> & order) {
+    size_t n = keys.size();
+    order.resize(n);
+    if (n == 0)
+        return;
+
+    uint32_t workers = n >= PARALLEL_THRESHOLD ? threads : 1;
+    size_t chunk = (n + workers - 1) / workers;
+    histograms.resize(workers);
+    for (int i = 0; i < 2; i++) {
+        keyBuffers[i].resize(n);
+        indexBuffers[i].resize(n);
+    }
+
+    // Bits that differ between keys, passes over constant bytes are skipped
+    uint64_t varying = 0;
+    for (size_t i = 0; i < n; i++) {
+        keyBuffers[0][i] = keys[i];
+        indexBuffers[0][i] = i;
+        varying |= keys[i] ^ keys[0];
+    }
+
+    int source = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & 0xFF) == 0)
+            continue;
+
+        const uint64_t * sourceKeys = keyBuffers[source].data();
+        const uint32_t * sourceIndices = indexBuffers[source].data();
+        uint64_t * targetKeys = keyBuffers[1 - source].data();
+        uint32_t * targetIndices = indexBuffers[1 - source].data();
+
+        // Histogram of each chunk
+        parallel(workers, [&](uint32_t worker) {
+            std::array<size_t, 256> & histogram = histograms[worker];
+            histogram.fill(0);
+            size_t end = std::min(n, (worker + 1) * chunk);
+            for (size_t i = worker * chunk; i < end; i++)
+                histogram[(sourceKeys[i] >> shift) & 0xFF]++;
+        });
+
+        // Digit major then chunk order, chunks scatter in place and the pass stays stable
+        size_t offset = 0;
+        for (uint32_t digit = 0; digit < 256; digit++) {
+            for (uint32_t worker = 0; worker < workers; worker++) {
+                size_t count = histograms[worker][digit];
+                histograms[worker][digit] = offset;
+                offset += count;
+            }
+        }
+
+        parallel(workers, [&](uint32_t worker) {
+            std::array<size_t, 256> & offsets = histograms[worker];
+            size_t end = std::min(n, (worker + 1) * chunk);
+            for (size_t i = worker * chunk; i < end; i++) {
+                size_t target = offsets[(sourceKeys[i] >> shift) & 0xFF]++;
+                targetKeys[target] = sourceKeys[i];
+                targetIndices[target] = sourceIndices[i];
+            }
+        });
+
+        source = 1 - source;
+    }
+
+    std::copy(indexBuffers[source].begin(), indexBuffers[source].end(), order.begin());
+}
+
+/*
+ *  Internal methods
+ */
+
+void RadixSorter::parallel(uint32_t count, const std::function<void(uint32_t)> & job_) {
+    if (count <= 1) {
+        job_(0);
+        return;
+    }
+
+    // Starting threads every pass costs more than the pass itself at the threshold size
+    if (pool.empty())
+        for (uint32_t i = 1; i < threads; i++)
+            pool.emplace_back(&RadixSorter::work, this, i);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &job_;
+        jobCount = count;
+        pending = pool.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    job_(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return pending == 0; });
+}
+
+void RadixSorter::work(uint32_t worker) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+
+        // Workers past the job count only check in
+        if (worker < jobCount) {
+            const std::function<void(uint32_t)> * current = job;
+            lock.unlock();
+            (*current)(worker);
+            lock.lock();
+        }
+
+        if (--pending == 0)
+            done.notify_one();
+    }
+}
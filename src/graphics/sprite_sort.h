@@ -0,0 +1,74 @@
+#ifndef SPRITE_SORT_H
+#define SPRITE_SORT_H
+
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+namespace uengine::graphics {
+
+    // 64 bit draw order keys, compared as integers:
+    //   layer (8 bits) | depth (32 bits) | pipeline (8 bits) | texture id (16 bits)
+    // Layer and depth give the blending order, pipeline and texture only order instances of
+    // equal depth so they end up in the same draw. Fewer depth bits trade ordering precision
+    // for larger groups.
+    class SortKeyEncoder {
+        public:
+            // Depths are mapped from back (drawn first) to front (drawn last), either way round
+            SortKeyEncoder(float backDepth, float frontDepth, uint32_t depthBits = 16);
+
+            uint64_t encode(uint32_t layer, float depth, uint32_t pipeline, uint32_t textureId);
+
+            static uint32_t getLayer(uint64_t key);
+            static uint32_t getPipeline(uint64_t key);
+            static uint32_t getTextureId(uint64_t key);
+
+        private:
+            float backDepth, frontDepth;
+            uint32_t depthBits;
+    };
+
+    // Stable LSD radix sort of 64 bit keys, 8 bits per pass. Bytes equal in every key are
+    // skipped, so the cost follows the bits actually used. Above PARALLEL_THRESHOLD keys the
+    // histograms and the scatter of each pass are split over threads.
+    // Buffers and worker threads are kept between calls, sort every frame with the same sorter.
+    // Workers are only started by the first parallel sort.
+    class RadixSorter {
+        public:
+            static constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
+
+            RadixSorter(uint32_t threads = 0); // 0 uses every hardware thread
+            ~RadixSorter();
+            RadixSorter(const RadixSorter &) = delete;
+            RadixSorter & operator=(const RadixSorter &) = delete;
+
+            // Indices of keys in ascending key order, equal keys keep their order
+            void sort(const std::vector<uint64_t> & keys, std::vector<uint32_t> & order);
+
+        private:
+            uint32_t threads;
+            std::vector<uint64_t> keyBuffers[2];
+            std::vector<uint32_t> indexBuffers[2];
+            std::vector<std::array<size_t, 256>> histograms; // Per thread
+
+            // Worker pool, thread i runs job(i) once per generation, the caller runs job(0)
+            std::vector<std::thread> pool;
+            std::mutex mutex;
+            std::condition_variable wake, done;
+            const std::function<void(uint32_t)> * job = nullptr;
+            uint32_t jobCount = 0;
+            uint32_t pending = 0;
+            uint64_t generation = 0;
+            bool stopping = false;
+
+            void parallel(uint32_t count, const std::function<void(uint32_t)> & job);
+            void work(uint32_t worker);
+    };
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "sprite_spatial_hash.h"
+
+using namespace uengine::graphics;
+
+SpriteSpatialHash::SpriteSpatialHash(float cellSize_) {
+    cellSize = cellSize_;
+}
+
+/*
+ *  External methods
+ */
+
+void SpriteSpatialHash::insert(SpriteBox * spriteBox) {
+    if (entryIndices.count(spriteBox))
+        return update(spriteBox);
+
+    uint32_t index;
+    if (!freeEntries.empty()) {
+        index = freeEntries.back();
+        freeEntries.pop_back();
+    } else {
+        index = entries.size();
+        entries.emplace_back();
+    }
+
+    Entry & entry = entries[index];
+    entry.spriteBox = spriteBox;
+    spriteBox->getBounds(entry.lower, entry.upper);
+    entry.firstCell = cellOf(entry.lower);
+    entry.lastCell = cellOf(entry.upper);
+    entryIndices[spriteBox] = index;
+    link(index);
+}
+
+void SpriteSpatialHash::remove(SpriteBox * spriteBox) {
+    auto it = entryIndices.find(spriteBox);
+    if (it == entryIndices.end())
+        return;
+
+    unlink(it->second);
+    entries[it->second].spriteBox = nullptr;
+    freeEntries.push_back(it->second);
+    entryIndices.erase(it);
+}
+
+void SpriteSpatialHash::update(SpriteBox * spriteBox) {
+    auto it = entryIndices.find(spriteBox);
+    if (it == entryIndices.end())
+        return insert(spriteBox);
+
+    Entry & entry = entries[it->second];
+    spriteBox->getBounds(entry.lower, entry.upper);
+
+    // Same cells, only the bounds used by the exact test change
+    glm::ivec2 firstCell = cellOf(entry.lower);
+    glm::ivec2 lastCell = cellOf(entry.upper);
+    if (firstCell == entry.firstCell && lastCell == entry.lastCell)
+        return;
+
+    unlink(it->second);
+    entry.firstCell = firstCell;
+    entry.lastCell = lastCell;
+    link(it->second);
+}
+
+void SpriteSpatialHash::clear() {
+    entries.clear();
+    freeEntries.clear();
+    entryIndices.clear();
+    cells.clear();
+    oversized.clear();
+}
+
+uint32_t SpriteSpatialHash::getCount() {
+    return entryIndices.size();
+}
+
+uint32_t SpriteSpatialHash::getCellCount() {
+    return cells.size();
+}
+
+void SpriteSpatialHash::query(glm::vec2 lower, glm::vec2 upper, std::vector<SpriteBox *> & result) {
+    // Boxes spanning several cells are met several times, the stamp reports them once
+    if (++queryStamp == 0) {
+        for (auto & entry : entries)
+            entry.queryStamp = 0;
+        queryStamp = 1;
+    }
+
+    auto test = [&](uint32_t index) {
+        Entry & entry = entries[index];
+        if (entry.queryStamp == queryStamp)
+            return;
+        entry.queryStamp = queryStamp;
+
+        if (entry.lower.x <= upper.x && entry.upper.x >= lower.x && entry.lower.y <= upper.y && entry.upper.y >= lower.y)
+            result.push_back(entry.spriteBox);
+    };
+
+    for (uint32_t index : oversized)
+        test(index);
+
+    // Past some size, looking up empty cells costs more than walking the occupied ones
+    glm::ivec2 firstCell = cellOf(lower);
+    glm::ivec2 lastCell = cellOf(upper);
+    if (cellSpan(firstCell, lastCell) > cells.size()) {
+        for (auto & [key, cell] : cells)
+            for (uint32_t index : cell)
+                test(index);
+        return;
+    }
+
+    for (int32_t y = firstCell.y; y <= lastCell.y; y++) {
+        for (int32_t x = firstCell.x; x <= lastCell.x; x++) {
+            auto it = cells.find(cellKey(x, y));
+            if (it == cells.end())
+                continue;
+            for (uint32_t index : it->second)
+                test(index);
+        }
+    }
+}
+
+void SpriteSpatialHash::query(glm::mat4 vp, std::vector<SpriteBox *> & result) {
+    if (std::abs(glm::determinant(vp)) < 1e-12f)
+        return;
+
+    // Bring the clip space corners back to the world plane, the camera is assumed affine (2D)
+    glm::mat4 inverseVP = glm::inverse(vp);
+    glm::vec2 lower(std::numeric_limits<float>::max());
+    glm::vec2 upper(std::numeric_limits<float>::lowest());
+    for (float x : {-1.0f, 1.0f}) {
+        for (float y : {-1.0f, 1.0f}) {
+            glm::vec4 world = inverseVP * glm::vec4(x, y, 0.0f, 1.0f);
+            glm::vec2 corner = glm::vec2(world) / world.w;
+            lower = glm::min(lower, corner);
+            upper = glm::max(upper, corner);
+        }
+    }
+
+    query(lower, upper, result);
+}
+
+/*
+ *  Internal methods
+ */
+
+uint64_t SpriteSpatialHash::cellKey(int32_t x, int32_t y) {
+    return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+}
+
+glm::ivec2 SpriteSpatialHash::cellOf(glm::vec2 position) {
+    // Clamped, far away boxes share the border cells rather than overflowing
+    glm::vec2 cell = glm::clamp(glm::floor(position / cellSize), glm::vec2(-1e9f), glm::vec2(1e9f));
+    return glm::ivec2(cell);
+}
+
+uint64_t SpriteSpatialHash::cellSpan(glm::ivec2 first, glm::ivec2 last) {
+    return (uint64_t) ((int64_t) last.x - first.x + 1) * (uint64_t) ((int64_t) last.y - first.y + 1);
+}
+
+void SpriteSpatialHash::removeIndex(std::vector<uint32_t> & indices, uint32_t index) {
+    // Order does not matter, swap with the last one
+    auto position = std::find(indices.begin(), indices.end(), index);
+    if (position != indices.end()) {
+        *position = indices.back();
+        indices.pop_back();
+    }
+}
+
+void SpriteSpatialHash::link(uint32_t index) {
+    Entry & entry = entries[index];
+    if (cellSpan(entry.firstCell, entry.lastCell) > MAX_CELLS_PER_BOX) {
+        oversized.push_back(index);
+        return;
+    }
+
+    for (int32_t y = entry.firstCell.y; y <= entry.lastCell.y; y++)
+        for (int32_t x = entry.firstCell.x; x <= entry.lastCell.x; x++)
+            cells[cellKey(x, y)].push_back(index);
+}
+
+void SpriteSpatialHash::unlink(uint32_t index) {
+    Entry & entry = entries[index];
+    if (cellSpan(entry.firstCell, entry.lastCell) > MAX_CELLS_PER_BOX) {
+        removeIndex(oversized, index);
+        return;
+    }
+
+    for (int32_t y = entry.firstCell.y; y <= entry.lastCell.y; y++) {
+        for (int32_t x = entry.firstCell.x; x <= entry.lastCell.x; x++) {
+            auto it = cells.find(cellKey(x, y));
+            if (it == cells.end())
+                continue;
+            removeIndex(it->second, index);
+            if (it->second.empty())
+                cells.erase(it);
+        }
+    }
+}
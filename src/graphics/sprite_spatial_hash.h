@@ -0,0 +1,63 @@
+#ifndef SPRITE_SPATIAL_HASH_H
+#define SPRITE_SPATIAL_HASH_H
+
+#include <vector>
+#include <unordered_map>
+#include <limits>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "sprite.h"
+
+namespace uengine::graphics {
+
+    // Uniform grid over the world, hashed so it is unbounded and only occupied cells cost memory.
+    // Sprite boxes are indexed by their animation bounds (SpriteBox::getBounds), so playing the
+    // animation needs no update, moving, resizing or changing the animation does.
+    // Queries return each box once, in no particular order.
+    class SpriteSpatialHash {
+        public:
+            static constexpr uint64_t MAX_CELLS_PER_BOX = 256; // Larger boxes are kept aside and always tested
+
+            SpriteSpatialHash(float cellSize);
+
+            void insert(SpriteBox * spriteBox);
+            void remove(SpriteBox * spriteBox);
+            void update(SpriteBox * spriteBox); // Cheap when the box stays in the same cells
+            void clear();
+            uint32_t getCount();
+            uint32_t getCellCount();
+
+            // Boxes whose bounds overlap the rect, appended to result
+            void query(glm::vec2 lower, glm::vec2 upper, std::vector<SpriteBox *> & result);
+            // Boxes visible through a 2D (affine) view projection
+            void query(glm::mat4 vp, std::vector<SpriteBox *> & result);
+
+        private:
+            float cellSize;
+
+            struct Entry {
+                SpriteBox * spriteBox;
+                glm::vec2 lower, upper;
+                glm::ivec2 firstCell, lastCell;
+                uint32_t queryStamp = 0;
+            };
+            std::vector<Entry> entries;
+            std::vector<uint32_t> freeEntries;
+            std::unordered_map<SpriteBox *, uint32_t> entryIndices;
+            std::unordered_map<uint64_t, std::vector<uint32_t>> cells; // Entry indices by cell key
+            std::vector<uint32_t> oversized;
+            uint32_t queryStamp = 0;
+
+            static uint64_t cellKey(int32_t x, int32_t y);
+            glm::ivec2 cellOf(glm::vec2 position);
+            static uint64_t cellSpan(glm::ivec2 first, glm::ivec2 last);
+            static void removeIndex(std::vector<uint32_t> & indices, uint32_t index);
+            void link(uint32_t index);
+            void unlink(uint32_t index);
+    };
+
+}
+
+#endif
@@ -0,0 +1,412 @@
+#include "tilemap_renderer.h"
+
+using namespace uengine::graphics;
+using GraphicsBase = uengine::graphics::GraphicsBase;
+namespace gh = uengine::graphics::helper;
+
+TilemapRenderer::TilemapRenderer(GraphicsBase * gb_, VkRenderPass * renderPass_, uint32_t width_, uint32_t height_, float tileSize_) {
+    gb = gb_;
+    renderPass = renderPass_;
+    width = width_;
+    height = height_;
+    tileSize = tileSize_;
+
+    chunksX = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunksY = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    tiles.assign((size_t) width * height, EMPTY_TILE);
+    chunks.resize((size_t) chunksX * chunksY);
+    retiredSlots.resize(gb->getFramesInFlight());
+
+    // Type 0 is the empty tile, never drawn
+    tileTypes.push_back({glm::vec2(0.0f), glm::vec2(0.0f), 0, 0});
+
+    setupPipeline();
+}
+
+TilemapRenderer::~TilemapRenderer() {
+    for (auto & page : pages) {
+        gb->unmapMemory(page.memory);
+        gb->destroyBuffer(page.buffer, nullptr);
+        gb->freeMemory(page.memory, nullptr);
+    }
+    gb->destroyPipeline(pipeline, nullptr);
+    gb->destroyPipelineLayout(pipelineLayout, nullptr);
+}
+
+/*
+ *  External methods
+ */
+
+void TilemapRenderer::setViewProjection(glm::mat4 vp_) {
+    vp = vp_;
+}
+
+void TilemapRenderer::setOrigin(glm::vec2 origin_) {
+    origin = origin_;
+    for (auto & chunk : chunks)
+        chunk.dirty = true;
+}
+
+uint32_t TilemapRenderer::addTileType(Sprite * sprite, glm::vec2 uvPos, glm::vec2 uvSize, glm::vec4 color) {
+    // The sprite texture has to be loaded, its table index is baked in the chunks
+    glm::vec2 textureSize((float) sprite->getWidth(), (float) sprite->getHeight());
+
+    TileType type;
+    type.uvPos = uvPos / textureSize;
+    type.uvSize = uvSize / textureSize;
+    type.color = gh::packColor(color);
+    type.textureId = sprite->getTextureId();
+    tileTypes.push_back(type);
+
+    return tileTypes.size() - 1;
+}
+
+uint32_t TilemapRenderer::getTileTypeCount() {
+    return tileTypes.size();
+}
+
+void TilemapRenderer::setTile(uint32_t x, uint32_t y, uint32_t type) {
+    if (x >= width || y >= height || type >= tileTypes.size())
+        return;
+
+    uint32_t & tile = tiles[(size_t) y * width + x];
+    if (tile == type)
+        return;
+
+    tile = type;
+    chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE].dirty = true;
+}
+
+uint32_t TilemapRenderer::getTile(uint32_t x, uint32_t y) {
+    if (x >= width || y >= height)
+        return EMPTY_TILE;
+    return tiles[(size_t) y * width + x];
+}
+
+uint32_t TilemapRenderer::getWidth() {
+    return width;
+}
+
+uint32_t TilemapRenderer::getHeight() {
+    return height;
+}
+
+uint32_t TilemapRenderer::getChunkCount() {
+    return chunks.size();
+}
+
+uint32_t TilemapRenderer::getVisibleChunkCount() {
+    return visibleChunkCount;
+}
+
+uint32_t TilemapRenderer::getRebuiltChunkCount() {
+    return rebuiltChunkCount;
+}
+
+uint32_t TilemapRenderer::getDrawnTileCount() {
+    return drawnTileCount;
+}
+
+uint32_t TilemapRenderer::getPageCount() {
+    return pages.size();
+}
+
+void TilemapRenderer::render(VkCommandBuffer cb) {
+    visibleChunkCount = 0;
+    rebuiltChunkCount = 0;
+    drawnTileCount = 0;
+
+    // The frame that last recorded this slot has completed, so have the frames before it
+    auto & retired = retiredSlots[gb->getCurrentFrame()];
+    for (auto & slot : retired)
+        freeSlots[slot.sizeClass].push_back(slot);
+    retired.clear();
+
+    glm::uvec2 first, last;
+    if (!getVisibleChunks(first, last))
+        return;
+
+    PushConstants pushConstants = {vp, tileSize};
+    VkDescriptorSet textureTable = gb->getTextureTable();
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdPushConstants(cb, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pushConstants);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &textureTable, 0, nullptr);
+
+    bool bindless = gb->hasBindlessTextures();
+
+    for (uint32_t cy = first.y; cy <= last.y; cy++) {
+        for (uint32_t cx = first.x; cx <= last.x; cx++) {
+            Chunk & chunk = chunks[cy * chunksX + cx];
+            visibleChunkCount++;
+
+            // Edits of chunks out of view wait until they are seen
+            if (chunk.dirty) {
+                rebuildChunk(cx, cy);
+                rebuiltChunkCount++;
+            }
+
+            if (chunk.instanceCount == 0)
+                continue;
+
+            vkCmdBindVertexBuffers(cb, 0, 1, &pages[chunk.slot.page].buffer, &chunk.slot.offset);
+            drawnTileCount += chunk.instanceCount;
+
+            if (bindless) {
+                vkCmdDraw(cb, 6, chunk.instanceCount, 0, 0);
+                continue;
+            }
+
+            // Without bindless textures the texture index must stay uniform within a draw
+            uint32_t firstInstance = 0;
+            for (auto & [textureId, count] : chunk.ranges) {
+                vkCmdDraw(cb, 6, count, 0, firstInstance);
+                firstInstance += count;
+            }
+        }
+    }
+}
+
+/*
+ *  Internal methods
+ */
+
+void TilemapRenderer::rebuildChunk(uint32_t cx, uint32_t cy) {
+    Chunk & chunk = chunks[cy * chunksX + cx];
+    chunk.dirty = false;
+
+    std::vector<TileInstanceData> instances;
+    instances.reserve(CHUNK_SIZE * CHUNK_SIZE);
+
+    uint32_t xEnd = std::min(width, (cx + 1) * CHUNK_SIZE);
+    uint32_t yEnd = std::min(height, (cy + 1) * CHUNK_SIZE);
+    for (uint32_t y = cy * CHUNK_SIZE; y < yEnd; y++) {
+        for (uint32_t x = cx * CHUNK_SIZE; x < xEnd; x++) {
+            uint32_t type = tiles[(size_t) y * width + x];
+            if (type == EMPTY_TILE)
+                continue;
+
+            const TileType & tileType = tileTypes[type];
+            TileInstanceData instance;
+            instance.position = origin + glm::vec2((float) x, (float) y) * tileSize;
+            instance.uvPos = tileType.uvPos;
+            instance.uvSize = tileType.uvSize;
+            instance.color = tileType.color;
+            instance.textureId = tileType.textureId;
+            instances.push_back(instance);
+        }
+    }
+
+    // Group by texture so the fallback path draws one range per texture
+    std::stable_sort(instances.begin(), instances.end(), [](const TileInstanceData & a, const TileInstanceData & b) {
+        return a.textureId < b.textureId;
+    });
+
+    chunk.ranges.clear();
+    for (auto & instance : instances) {
+        if (chunk.ranges.empty() || chunk.ranges.back().first != instance.textureId)
+            chunk.ranges.push_back({instance.textureId, 0});
+        chunk.ranges.back().second++;
+    }
+
+    // Pending frames may still read the previous slot, it is only reused once they have completed
+    releaseChunk(chunk);
+    chunk.instanceCount = instances.size();
+    if (instances.empty())
+        return;
+
+    chunk.slot = allocateSlot(chunk.instanceCount);
+    memcpy(pages[chunk.slot.page].data + chunk.slot.offset, instances.data(), instances.size() * sizeof(TileInstanceData));
+}
+
+void TilemapRenderer::releaseChunk(Chunk & chunk) {
+    if (chunk.instanceCount == 0)
+        return;
+
+    retiredSlots[gb->getCurrentFrame()].push_back(chunk.slot);
+    chunk.instanceCount = 0;
+}
+
+TilemapRenderer::Slot TilemapRenderer::allocateSlot(uint32_t instanceCount) {
+    uint32_t sizeClass = 0;
+    while ((MIN_SLOT_INSTANCES << sizeClass) < instanceCount)
+        sizeClass++;
+    if (sizeClass >= freeSlots.size())
+        freeSlots.resize(sizeClass + 1);
+
+    // Out of slots of that size, a new page is carved in them
+    std::vector<Slot> & available = freeSlots[sizeClass];
+    if (available.empty()) {
+        Page page;
+        gb->createBuffer(
+            PAGE_SIZE,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            page.buffer,
+            page.memory);
+
+        void * data;
+        gb->mapMemory(page.memory, 0, PAGE_SIZE, 0, &data);
+        page.data = (uint8_t *) data;
+        pages.push_back(page);
+
+        VkDeviceSize slotSize = (VkDeviceSize) (MIN_SLOT_INSTANCES << sizeClass) * sizeof(TileInstanceData);
+        for (VkDeviceSize offset = PAGE_SIZE / slotSize * slotSize; offset >= slotSize; offset -= slotSize)
+            available.push_back({(uint32_t) pages.size() - 1, offset - slotSize, sizeClass});
+    }
+
+    Slot slot = available.back();
+    available.pop_back();
+    return slot;
+}
+
+bool TilemapRenderer::getVisibleChunks(glm::uvec2 & first, glm::uvec2 & last) {
+    if (chunks.empty() || std::abs(glm::determinant(vp)) < 1e-12f)
+        return false;
+
+    // Bring the clip space corners back to the map plane, the camera is assumed affine (2D)
+    glm::mat4 inverseVP = glm::inverse(vp);
+    glm::vec2 lower(std::numeric_limits<float>::max());
+    glm::vec2 upper(std::numeric_limits<float>::lowest());
+    for (float x : {-1.0f, 1.0f}) {
+        for (float y : {-1.0f, 1.0f}) {
+            glm::vec4 world = inverseVP * glm::vec4(x, y, 0.0f, 1.0f);
+            glm::vec2 corner = glm::vec2(world) / world.w;
+            lower = glm::min(lower, corner);
+            upper = glm::max(upper, corner);
+        }
+    }
+
+    // World rect to chunk index range
+    float chunkWorldSize = tileSize * CHUNK_SIZE;
+    glm::vec2 firstChunk = glm::floor((lower - origin) / chunkWorldSize);
+    glm::vec2 lastChunk = glm::floor((upper - origin) / chunkWorldSize);
+
+    if (lastChunk.x < 0.0f || lastChunk.y < 0.0f || firstChunk.x >= chunksX || firstChunk.y >= chunksY)
+        return false;
+
+    first = glm::uvec2(glm::max(firstChunk, glm::vec2(0.0f)));
+    last = glm::uvec2(glm::min(lastChunk, glm::vec2((float) chunksX - 1, (float) chunksY - 1)));
+    return true;
+}
+
+
+/*---------------- Pipeline -----------------*/
+
+void TilemapRenderer::setupPipeline() {
+    // Shaders
+    VkShaderModule vertShaderModule = gb->createShaderModule("res/shaders/tilemap/vert.spv");
+    // The bindless variant indexes the texture table with non-uniform indices
+    VkShaderModule fragShaderModule = gb->createShaderModule(gb->hasBindlessTextures()
+        ? "res/shaders/tilemap/frag_bindless.spv"
+        : "res/shaders/tilemap/frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+    shaderStages[0] = gh::pipelineShaderStageCreateInfo(vertShaderModule, VK_SHADER_STAGE_VERTEX_BIT);
+    shaderStages[1] = gh::pipelineShaderStageCreateInfo(fragShaderModule, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Vertex input, the unit quad is hardcoded in the shader and tiles are per instance attributes
+    VkPipelineVertexInputStateCreateInfo vertexInputState = gh::pipelineVertexInputStateCreateInfo();
+
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions = {
+        gh::vertexInputBindingDescription(0, sizeof(TileInstanceData), VK_VERTEX_INPUT_RATE_INSTANCE)
+    };
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = {
+        gh::vertexInputAttributeDescription(0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(TileInstanceData, position)),
+        gh::vertexInputAttributeDescription(0, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(TileInstanceData, uvPos)),
+        gh::vertexInputAttributeDescription(0, 2, VK_FORMAT_R32G32_SFLOAT, offsetof(TileInstanceData, uvSize)),
+        gh::vertexInputAttributeDescription(0, 3, VK_FORMAT_R8G8B8A8_UNORM, offsetof(TileInstanceData, color)),
+        gh::vertexInputAttributeDescription(0, 4, VK_FORMAT_R32_SINT, offsetof(TileInstanceData, textureId))
+    };
+
+    vertexInputState.vertexBindingDescriptionCount = bindingDescriptions.size();
+    vertexInputState.pVertexBindingDescriptions = bindingDescriptions.data();
+    vertexInputState.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInputState.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState =
+        gh::pipelineInputAssemblyStateCreateInfo(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            0,
+            VK_FALSE);
+
+    // Viewport
+    VkPipelineViewportStateCreateInfo viewportState = gh::pipelineViewportStateCreateInfo(1, 1, 0);
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizationState =
+        gh::pipelineRasterizationStateCreateInfo(
+            VK_POLYGON_MODE_FILL,
+            VK_CULL_MODE_NONE,
+            VK_FRONT_FACE_CLOCKWISE,
+            0);
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampleState =
+        gh::pipelineMultisampleStateCreateInfo(
+            VK_SAMPLE_COUNT_1_BIT,
+            0);
+
+    // Color blend attachment
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState =
+        gh::pipelineColorBlendAttachmentState(
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+            VK_TRUE);
+    colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_MAX;
+
+    // Color blend state
+    VkPipelineColorBlendStateCreateInfo colorBlendState =
+        gh::pipelineColorBlendStateCreateInfo(
+            1,
+            &colorBlendAttachmentState);
+
+    // Dynamic state
+    std::vector<VkDynamicState> dynamicStateEnables = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState =
+        gh::pipelineDynamicStateCreateInfo(
+            dynamicStateEnables.data(),
+            dynamicStateEnables.size(),
+            0);
+
+    // Pipeline layout creation, set 0 is the texture table, view projection goes through push constants
+    std::array<VkDescriptorSetLayout, 1> setLayouts = {gb->getTextureTableLayout()};
+    VkPushConstantRange pushConstantRange = gh::pushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, sizeof(PushConstants));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+        gh::pipelineLayoutCreateInfo(
+            setLayouts.data(),
+            setLayouts.size());
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    gb->createPipelineLayout(&pipelineLayoutInfo, nullptr, &pipelineLayout);
+
+    // Actual pipeline creation
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = gh::pipelineCreateInfo(pipelineLayout, *renderPass, 0);
+    pipelineCreateInfo.pVertexInputState = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState = &multisampleState;
+    pipelineCreateInfo.pViewportState = &viewportState;
+    pipelineCreateInfo.pDynamicState = &dynamicState;
+    pipelineCreateInfo.stageCount = shaderStages.size();
+    pipelineCreateInfo.pStages = shaderStages.data();
+
+    gb->createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+
+    // Cleanup
+    gb->destroyShaderModule(vertShaderModule, nullptr);
+    gb->destroyShaderModule(fragShaderModule, nullptr);
+}
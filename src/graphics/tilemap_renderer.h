@@ -0,0 +1,128 @@
+#ifndef TILEMAP_RENDERER_H
+#define TILEMAP_RENDERER_H
+
+#include <array>
+#include <vector>
+#include <limits>
+
+#include <vulkan/vulkan.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "sprite.h"
+#include "graphics_base.h"
+#include "graphics_helper.h"
+
+namespace uengine::graphics {
+
+    // Per tile vertex input, one instance per non-empty tile
+    struct TileInstanceData {
+        alignas(8) glm::vec2 position; // Lower corner of the tile in world space
+        alignas(8) glm::vec2 uvPos;
+        alignas(8) glm::vec2 uvSize;
+        alignas(4) uint32_t color;     // RGBA8
+        alignas(4) int textureId;
+    };
+
+    struct TileType {
+        glm::vec2 uvPos;  // Normalized to the texture
+        glm::vec2 uvSize;
+        uint32_t color;
+        int textureId;
+    };
+
+    // Large tile layer split in fixed-size chunks. Each chunk keeps prebuilt instances, only chunks
+    // edited since their last build are rebuilt, and only when they come into view.
+    // Chunks outside the view-projection are skipped, the cost follows the visible chunk count.
+    // Chunk instances live in slots of a few large pooled buffers rather than one allocation each,
+    // a large map would otherwise run into maxMemoryAllocationCount.
+    class TilemapRenderer {
+        public:
+            static constexpr uint32_t CHUNK_SIZE = 32; // In tiles per side
+            static constexpr uint32_t EMPTY_TILE = 0;
+            static constexpr uint32_t MIN_SLOT_INSTANCES = 64;       // Slot sizes are powers of two from there
+            static constexpr VkDeviceSize PAGE_SIZE = 2 * 1024 * 1024; // Pooled buffer size, in bytes
+
+            TilemapRenderer(GraphicsBase * gb, VkRenderPass * renderPass, uint32_t width, uint32_t height, float tileSize);
+            ~TilemapRenderer();
+
+            void setViewProjection(glm::mat4 vp);
+            void setOrigin(glm::vec2 origin);
+
+            // Tile types are immutable, tiles refer to them by the returned id
+            uint32_t addTileType(Sprite * sprite, glm::vec2 uvPos, glm::vec2 uvSize, glm::vec4 color = glm::vec4(1.0f));
+            uint32_t getTileTypeCount();
+
+            void setTile(uint32_t x, uint32_t y, uint32_t type);
+            uint32_t getTile(uint32_t x, uint32_t y);
+            uint32_t getWidth();
+            uint32_t getHeight();
+
+            // Statistics of the last render
+            uint32_t getChunkCount();
+            uint32_t getVisibleChunkCount();
+            uint32_t getRebuiltChunkCount();
+            uint32_t getDrawnTileCount();
+            uint32_t getPageCount(); // Pooled buffers, one memory allocation each
+
+            void render(VkCommandBuffer cb);
+
+        private:
+            GraphicsBase * gb;
+            VkRenderPass * renderPass;
+
+            uint32_t width, height;
+            uint32_t chunksX, chunksY;
+            float tileSize;
+            glm::vec2 origin = glm::vec2(0.0f);
+            glm::mat4 vp = glm::mat4(1.0f);
+
+            std::vector<TileType> tileTypes;
+            std::vector<uint32_t> tiles;
+
+            // Pooled buffer, persistently mapped and carved in slots of a single size class
+            struct Page {
+                VkBuffer buffer;
+                VkDeviceMemory memory;
+                uint8_t * data;
+            };
+            struct Slot {
+                uint32_t page = 0;
+                VkDeviceSize offset = 0;
+                uint32_t sizeClass = 0;
+            };
+            std::vector<Page> pages;
+            std::vector<std::vector<Slot>> freeSlots;    // Per size class
+            std::vector<std::vector<Slot>> retiredSlots; // Per frame slot, free again once it comes round
+
+            struct Chunk {
+                Slot slot; // Only valid with instances
+                uint32_t instanceCount = 0;
+                std::vector<std::pair<int, uint32_t>> ranges; // Instance count per texture, in buffer order
+                bool dirty = false;
+            };
+            std::vector<Chunk> chunks;
+
+            uint32_t visibleChunkCount = 0;
+            uint32_t rebuiltChunkCount = 0;
+            uint32_t drawnTileCount = 0;
+
+            struct PushConstants {
+                alignas(16) glm::mat4 vp;
+                alignas(4) float tileSize;
+            };
+
+            VkPipelineLayout pipelineLayout;
+            VkPipeline pipeline;
+
+            void rebuildChunk(uint32_t cx, uint32_t cy);
+            void releaseChunk(Chunk & chunk);
+            Slot allocateSlot(uint32_t instanceCount);
+            bool getVisibleChunks(glm::uvec2 & first, glm::uvec2 & last);
+            void setupPipeline();
+    };
+
+}
+
+#endif
@@ -1229,3 +1229,12 @@ ImTextureID ImGui_ImplVulkan_AddTexture(VkSampler sampler, VkImageView image_vie
 
     return (ImTextureID)descriptor_set;
 }
+
+void ImGui_ImplVulkan_RemoveTexture(ImTextureID texture){
+    VkResult err;
+
+    ImGui_ImplVulkan_InitInfo* v = &g_VulkanInitInfo;
+    VkDescriptorSet descriptor_set = (VkDescriptorSet)texture;
+    err = vkFreeDescriptorSets(v->Device, v->DescriptorPool, 1, &descriptor_set);
+    check_vk_result(err);
+}
@@ -1,28 +1,259 @@
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
 
 #include "graphics_base.h"
 #include "drawable.h"
 #include "sprite_editor.h"
 #include "sprite.h"
 #include "sprite_manager.h"
+#include "benchmark_scene.h"
+#include "lighting_benchmark_scene.h"
+#include "tilemap_benchmark_scene.h"
+#include "outline_benchmark.h"
+#include "culling_benchmark.h"
+#include "sort_benchmark.h"
+#include "alpha_benchmark.h"
+#include "slice_benchmark.h"
+#include "outline_extractor.h"
 
 using namespace uengine::graphics;
 using namespace uengine::sprite_editor;
+using namespace uengine::benchmark;
+
+static void writePPM(std::string filename, VkExtent2D extent, std::vector<uint8_t> & pixels) {
+    std::ofstream file(filename, std::ios::binary);
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+    for (size_t i = 0; i < pixels.size(); i += 4)
+        file.write((const char *) &pixels[i], 3);
+}
+
+static const std::map<std::string, VkPresentModeKHR> presentModes = {
+    {"fifo", VK_PRESENT_MODE_FIFO_KHR},
+    {"mailbox", VK_PRESENT_MODE_MAILBOX_KHR},
+    {"immediate", VK_PRESENT_MODE_IMMEDIATE_KHR}
+};
 
 int main(int argc, char ** argv) {
-    GraphicsBase * gb = new GraphicsBase(1200, 600);
+    bool headless = false;
+    int frames = -1;
+    int benchmarkFrames = 0;
+    bool benchLowLatency = false;
+    float fpsLimit = 0.0f;
+    std::string presentMode;
+    std::string screenshot;
+    std::string bench;
+    int benchCount = -1; // Per benchmark default
+    std::string benchSprite;
+    bool benchGpuAnimation = false;
+    bool benchMeshes = false;
+    bool benchCull = false;
+    bool benchSorted = false;
+    int benchLights = 256;
+    int benchOccluders = 64;
+    int benchIterations = 20;
+    std::string extractOutlines;
+    int outlineVertices = 16;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::stoi(argv[++i]);
+        } else if (arg == "--screenshot" && i + 1 < argc) {
+            screenshot = argv[++i];
+        } else if (arg == "--present-mode" && i + 1 < argc && presentModes.count(argv[i + 1])) {
+            presentMode = argv[++i];
+        } else if (arg == "--fps-limit" && i + 1 < argc) {
+            fpsLimit = std::stof(argv[++i]);
+        } else if (arg == "--benchmark-frames" && i + 1 < argc) {
+            benchmarkFrames = std::stoi(argv[++i]);
+        } else if (arg == "--benchmark-low-latency") {
+            benchLowLatency = true;
+        } else if (arg == "--bench" && i + 1 < argc) {
+            bench = argv[++i];
+        } else if (arg == "--bench-count" && i + 1 < argc) {
+            benchCount = std::stoi(argv[++i]);
+        } else if (arg == "--bench-sprite" && i + 1 < argc) {
+            benchSprite = argv[++i];
+        } else if (arg == "--bench-gpu-animation") {
+            benchGpuAnimation = true;
+        } else if (arg == "--bench-meshes") {
+            benchMeshes = true;
+        } else if (arg == "--bench-cull") {
+            benchCull = true;
+        } else if (arg == "--bench-sorted") {
+            benchSorted = true;
+        } else if (arg == "--bench-lights" && i + 1 < argc) {
+            benchLights = std::stoi(argv[++i]);
+        } else if (arg == "--bench-occluders" && i + 1 < argc) {
+            benchOccluders = std::stoi(argv[++i]);
+        } else if (arg == "--bench-iterations" && i + 1 < argc) {
+            benchIterations = std::stoi(argv[++i]);
+        } else if (arg == "--extract-outlines" && i + 1 < argc) {
+            extractOutlines = argv[++i];
+        } else if (arg == "--outline-vertices" && i + 1 < argc) {
+            outlineVertices = std::stoi(argv[++i]);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--headless] [--frames N] [--screenshot file.ppm]"
+                << " [--present-mode fifo|mailbox|immediate] [--fps-limit FPS] [--benchmark-frames N [--benchmark-low-latency]]"
+                << " [--bench sprites --bench-sprite file.spr [--bench-count N] [--bench-gpu-animation] [--bench-meshes] [--bench-cull] [--bench-sorted]]"
+                << " [--bench lighting [--bench-lights N] [--bench-occluders N]]"
+                << " [--bench tilemap --bench-sprite file.spr [--bench-count N]]"
+                << " [--bench outlines --bench-sprite file.spr [--bench-iterations N]]"
+                << " [--bench culling --bench-sprite file.spr [--bench-count N] [--bench-iterations N]]"
+                << " [--bench sort [--bench-iterations N]]"
+                << " [--bench alpha [--bench-iterations N]]"
+                << " [--bench slice [--bench-iterations N]]"
+                << " [--extract-outlines file.spr [--outline-vertices N]]" << std::endl;
+            return 1;
+        }
+    }
+
+    // CPU benchmarks and tools run once then exit, they only need the device to load textures
+    bool cpuBench = bench == "outlines" || bench == "culling";
+    bool needsSprite = bench == "sprites" || bench == "tilemap" || cpuBench;
+    if (!bench.empty() && ((bench != "sprites" && bench != "lighting" && bench != "tilemap" && bench != "sort" && bench != "alpha" && bench != "slice" && !cpuBench) || (needsSprite && benchSprite.empty()))) {
+        std::cout << "Unknown benchmark or missing --bench-sprite: " << bench << std::endl;
+        return 1;
+    }
+
+    // Sorting, alpha indexing and slicing need no device at all
+    if (bench == "sort") {
+        SortBenchmark(benchIterations).run();
+        return 0;
+    }
+    if (bench == "alpha") {
+        AlphaBenchmark(benchIterations).run();
+        return 0;
+    }
+    if (bench == "slice") {
+        SliceBenchmark(benchIterations).run();
+        return 0;
+    }
+    if (cpuBench || !extractOutlines.empty())
+        headless = true;
+
+    // Benchmarks measure throughput, run uncapped unless asked otherwise
+    if (benchmarkFrames > 0) {
+        frames = benchmarkFrames;
+        if (presentMode.empty())
+            presentMode = "immediate";
+    }
+
+    // A headless run has no window to close, render a single frame by default
+    if (headless && frames < 0)
+        frames = 1;
+
+    GraphicsBase * gb = new GraphicsBase(1200, 600, headless);
+    if (!presentMode.empty())
+        gb->setPresentMode(presentModes.at(presentMode));
+    gb->getFramePacer()->setFpsLimit(fpsLimit);
 
-    SpriteEditor * se = new SpriteEditor(gb);
-    gb->addDrawable((Drawable *) se);
+    // Low latency waits on every frame in flight, the CPU and GPU would never overlap
+    if (benchmarkFrames > 0)
+        gb->setLowLatency(benchLowLatency);
 
-    SpriteManager * sm = new SpriteManager("res/sprites/", gb);
+    if (cpuBench || !extractOutlines.empty()) {
+        Sprite * sprite = new Sprite(gb);
+        sprite->setFilename(cpuBench ? benchSprite : extractOutlines);
+        sprite->load();
+        sprite->loadTexture(true);
 
-    while (!gb->shouldClose()) {
+        if (bench == "outlines") {
+            OutlineBenchmark(sprite, benchIterations).run();
+        } else if (bench == "culling") {
+            CullingBenchmark(sprite, benchCount > 0 ? benchCount : 1000000, benchIterations).run();
+        } else {
+            OutlineSettings settings;
+            settings.maxVertices = outlineVertices;
+            uint32_t extracted = OutlineExtractor(settings).extractSprite(sprite, true);
+            sprite->save(extractOutlines);
+            std::cout << "outlines extracted for " << extracted << " frames" << std::endl;
+        }
+
+        delete sprite;
+        delete gb;
+        return 0;
+    }
+
+    SpriteEditor * se = nullptr;
+    SpriteManager * sm = nullptr;
+    Sprite * sprite = nullptr;
+    BenchmarkScene * scene = nullptr;
+    LightingBenchmarkScene * lightingScene = nullptr;
+    TilemapBenchmarkScene * tilemapScene = nullptr;
+
+    if (bench.empty()) {
+        se = new SpriteEditor(gb);
+        gb->addDrawable((Drawable *) se);
+
+        sm = new SpriteManager("res/sprites/", gb);
+    } else if (bench == "lighting") {
+        lightingScene = new LightingBenchmarkScene(gb, benchLights, benchOccluders);
+        gb->addDrawable((Drawable *) lightingScene);
+    } else if (bench == "tilemap") {
+        sprite = new Sprite(gb);
+        sprite->setFilename(benchSprite);
+        sprite->load();
+
+        // Tiles per side, the default map has 4096 chunks
+        tilemapScene = new TilemapBenchmarkScene(gb, sprite, benchCount > 0 ? benchCount : 2048);
+        gb->addDrawable((Drawable *) tilemapScene);
+    } else {
+        sprite = new Sprite(gb);
+        sprite->setFilename(benchSprite);
+        sprite->load();
+
+        scene = new BenchmarkScene(gb, sprite, benchCount > 0 ? benchCount : 100000, benchGpuAnimation, benchMeshes, benchCull, benchSorted);
+        gb->addDrawable((Drawable *) scene);
+    }
+
+    if (benchmarkFrames > 0)
+        gb->getFramePacer()->startRecording(benchmarkFrames);
+
+    for (int frame = 0; !gb->shouldClose() && (frames < 0 || frame < frames); frame++) {
+        // Wait for a free frame first, input is then as fresh as possible when rendered
+        gb->waitFrame();
         gb->poolEvents();
-        se->update();
+        if (se)
+            se->update();
+        if (scene)
+            scene->update();
+        if (lightingScene)
+            lightingScene->update();
+        if (tilemapScene)
+            tilemapScene->update();
         gb->draw();
     }
 
+    if (benchmarkFrames > 0) {
+        FramePacer * pacer = gb->getFramePacer();
+        pacer->stopRecording();
+        std::cout << "frames: " << pacer->getRecordedFrameTimes().size()
+            << " (" << (gb->isLowLatency() ? "low latency" : "pipelined") << ")"
+            << ", p50: " << pacer->percentile(50) << " ms"
+            << ", p95: " << pacer->percentile(95) << " ms"
+            << ", p99: " << pacer->percentile(99) << " ms" << std::endl;
+    }
+
+    if (!screenshot.empty()) {
+        if (headless) {
+            std::vector<uint8_t> pixels;
+            gb->readPixels(pixels);
+            writePPM(screenshot, gb->getExtent(), pixels);
+        } else {
+            std::cout << "--screenshot requires --headless" << std::endl;
+        }
+    }
+
+    delete scene;
+    delete lightingScene;
+    delete tilemapScene;
+    delete sprite;
     delete sm;
     delete se;
     delete gb;
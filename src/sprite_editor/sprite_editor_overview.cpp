@@ -8,15 +8,22 @@ using Skin = uengine::graphics::Skin;
 using Animation = uengine::graphics::Animation;
 using Frame = uengine::graphics::Frame;
 using FrameData = uengine::graphics::FrameData;
-using SpritePreview = uengine::graphics::SpritePreview;
+using SpriteBox = uengine::graphics::SpriteBox;
+using PreviewAtlas = uengine::graphics::PreviewAtlas;
 using GraphicsGrid = uengine::graphics::GraphicsGrid;
 using GraphicsQuads = uengine::graphics::GraphicsQuads;
+using AlphaIndex = uengine::graphics::AlphaIndex;
+using AlphaScan = uengine::graphics::AlphaScan;
+using SpriteSlicer = uengine::graphics::SpriteSlicer;
+using SlicerSettings = uengine::graphics::SlicerSettings;
+using Slice = uengine::graphics::Slice;
 namespace fs = std::experimental::filesystem;
 
 SpriteEditorOverview::SpriteEditorOverview(GraphicsBase * gb_) {
     gb = gb_;
     
     overview.mv.seor = new SpriteEditorOverviewRenderer(gb);
+    overview.sp.previewAtlas = new PreviewAtlas(gb, 512, 512);
 
     fileBrowser = FileBrowser();
 
@@ -41,15 +48,10 @@ SpriteEditorOverview::~SpriteEditorOverview() {
     clearSpritePanelData();
     delete overview.sprite;
     delete overview.mv.seor;
+    delete overview.sp.previewAtlas;
 }
 
 void SpriteEditorOverview::update() {
-    if (overview.sp.deleteRequest) {
-        // Deleting only now because we don't want to interfere with rendering
-        deleteAnimation();
-        overview.sp.deleteRequest = false;
-    }
-
     updateParameters();
     updatePreviews();
 }
@@ -61,16 +63,12 @@ void SpriteEditorOverview::renderUI() {
     showGeneralPanel();
     showMainView();
     showSpritePanel();
+    showStatsOverlay();
 }
 
 void SpriteEditorOverview::render(VkCommandBuffer cb) {
     overview.mv.seor->render(cb);
-    if (overview.sp.selectedAnimationPreview) {
-        overview.sp.selectedAnimationPreview->render(cb);
-    }
-    for (auto preview : overview.sp.animationPreviews) {
-        preview->render(cb);
-    }
+    overview.sp.previewAtlas->render(cb);
 }
 
 void SpriteEditorOverview::resize(int32_t width, int32_t height) {
@@ -81,28 +79,71 @@ void SpriteEditorOverview::resize(int32_t width, int32_t height) {
 
     resetProjection();
     overview.mv.seor->setViewProjection(overview.mv.projection * overview.mv.view);
-    overview.mv.seor->resize(width, height);
+    overview.mv.seor->resize(overview.mv.size.x, overview.mv.size.y);
 }
 
 void SpriteEditorOverview::updatePreviews() {
-    if (overview.sp.selectedAnimationPreview) {
-        overview.sp.selectedAnimationPreview->update();
+    // Only thumbnails shown in the animation list exist, the cost follows the list height
+    overview.sp.previewAtlas->update();
+}
+
+int SpriteEditorOverview::acquireAnimationPreview(int animation) {
+    int & preview = overview.sp.animationPreviews[animation];
+    if (preview < 0) {
+        // With the atlas full, the row goes without a thumbnail
+        preview = overview.sp.previewAtlas->add(overview.sprite, 32, 32);
+        if (preview < 0)
+            return preview;
+        SpriteBox * spriteBox = overview.sp.previewAtlas->getSpriteBox(preview);
+        spriteBox->setSkin(overview.sp.selectedSkin);
+        spriteBox->setAnimation(overview.sp.animations[animation]);
+        overview.sp.shownAnimationPreviews.push_back(animation);
     }
-    for (auto preview : overview.sp.animationPreviews) {
-        preview->update();
+    return preview;
+}
+
+void SpriteEditorOverview::acquireAnimationPreviews(int begin, int end) {
+    end = std::min(end, (int) overview.sp.animations.size());
+    releaseAnimationPreviews(begin, end);
+    for (int i = begin; i < end; i++)
+        acquireAnimationPreview(i);
+}
+
+void SpriteEditorOverview::releaseAnimationPreviews(int begin, int end) {
+    std::vector<int> & shown = overview.sp.shownAnimationPreviews;
+    for (size_t i = 0; i < shown.size();) {
+        int animation = shown[i];
+        if (animation >= begin && animation < end) {
+            i++;
+            continue;
+        }
+        overview.sp.previewAtlas->remove(overview.sp.animationPreviews[animation]);
+        overview.sp.animationPreviews[animation] = -1;
+        shown[i] = shown.back();
+        shown.pop_back();
     }
 }
 
 void SpriteEditorOverview::updateCurrentSelection() {
     GraphicsQuads * quads = overview.mv.seor->getCurrentSelectionQuads();
-    quads->clear();
-    
-    Rect rect = overview.mv.rect;
-    quads->addRect(rect.pos[0], rect.pos[1], rect.pos[0] + rect.size[0], rect.pos[1] + rect.size[1],
-                   rect.color[0], rect.color[1], rect.color[2], rect.color[3], true);
-    for (Rect rect : overview.mv.subRects) {
-        quads->addRect(rect.pos[0], rect.pos[1], rect.pos[0] + rect.size[0], rect.pos[1] + rect.size[1],
-                       rect.color[0], rect.color[1], rect.color[2], rect.color[3], false);
+    std::vector<GraphicsQuads::Handle> & handles = overview.mv.selectionQuads;
+
+    // Rectangles keep their handle while the selection is edited, only the moved ones are uploaded again
+    size_t count = overview.mv.subRects.size() + 1;
+    while (handles.size() > count) {
+        quads->remove(handles.back());
+        handles.pop_back();
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        Rect rect = i == 0 ? overview.mv.rect : overview.mv.subRects[i - 1];
+        if (i < handles.size()) {
+            quads->setRect(handles[i], rect.pos[0], rect.pos[1], rect.pos[0] + rect.size[0], rect.pos[1] + rect.size[1],
+                           rect.color[0], rect.color[1], rect.color[2], rect.color[3]);
+        } else {
+            handles.push_back(quads->addRect(rect.pos[0], rect.pos[1], rect.pos[0] + rect.size[0], rect.pos[1] + rect.size[1],
+                                             rect.color[0], rect.color[1], rect.color[2], rect.color[3], i == 0));
+        }
     }
 }
 
@@ -113,6 +154,7 @@ void SpriteEditorOverview::load(fs::path file) {
         delete overview.sprite;
     }
     overview.sprite = new Sprite(gb);
+    overview.gp.sel.free.components.sprite = nullptr; // The new sprite may reuse the address of the old one
     std::cout << "OPENING " << file << std::endl;
     overview.sprite->setFilename(file);
     overview.sprite->load();
@@ -138,16 +180,14 @@ void SpriteEditorOverview::clearSpritePanelData() {
     overview.sp.selectedSkin = nullptr;
 
     overview.sp.selectedAnimation = nullptr;
-    if (overview.sp.selectedAnimationPreview) {
-        delete overview.sp.selectedAnimationPreview;
-    }
-    overview.sp.selectedAnimationPreview = nullptr;
+    overview.sp.selectedAnimationPreview = -1;
     
     overview.sp.animations.clear();
-    for (auto preview : overview.sp.animationPreviews) {
-        delete preview;
-    }
     overview.sp.animationPreviews.clear();
+    overview.sp.shownAnimationPreviews.clear();
+    overview.sp.previewBegin = overview.sp.previewEnd = 0;
+    overview.sp.deletePending = false; // Meant for the animation just cleared
+    overview.sp.previewAtlas->clear();
 }
 
 void SpriteEditorOverview::fillSpritePanelData(Skin * skin) {
@@ -161,29 +201,22 @@ void SpriteEditorOverview::fillSpritePanelData(Skin * skin) {
     }
 
     float backgroundColor[4] = {0, 0, 0, 0};
+    overview.sp.previewAtlas->setBackgroundColor(backgroundColor);
 
     overview.sp.selectedAnimation = overview.sp.selectedSkin->getAnimation("");
     if (!overview.sp.selectedAnimation) {
         return;
     } else {
-        overview.sp.selectedAnimationPreview = new SpritePreview(gb, overview.sprite, 224, 224);
-        overview.sp.selectedAnimationPreview->setViewProjection(glm::mat4(1.0f));
-        overview.sp.selectedAnimationPreview->setBackgroundColor(backgroundColor);
-        overview.sp.selectedAnimationPreview->getSpriteBox()->setSkin(overview.sp.selectedSkin);
-        overview.sp.selectedAnimationPreview->getSpriteBox()->setAnimation(overview.sp.selectedAnimation);
-        overview.sp.selectedAnimationPreview->update();
+        overview.sp.selectedAnimationPreview = overview.sp.previewAtlas->add(overview.sprite, 224, 224);
+        SpriteBox * spriteBox = overview.sp.previewAtlas->getSpriteBox(overview.sp.selectedAnimationPreview);
+        spriteBox->setSkin(overview.sp.selectedSkin);
+        spriteBox->setAnimation(overview.sp.selectedAnimation);
     }
 
+    // Thumbnails are created once their row scrolls into the animation list
     for (auto el : *overview.sp.selectedSkin->getAnimations()) {
-        Animation * animation = el.second;
-        overview.sp.animations.push_back(animation);
-        SpritePreview * spritePreview = new SpritePreview(gb, overview.sprite, 32, 32);
-        spritePreview->setViewProjection(glm::mat4(1.0f));
-        spritePreview->setBackgroundColor(backgroundColor);
-        spritePreview->getSpriteBox()->setSkin(overview.sp.selectedSkin);
-        spritePreview->getSpriteBox()->setAnimation(animation);
-        spritePreview->update();
-        overview.sp.animationPreviews.push_back(spritePreview);
+        overview.sp.animations.push_back(el.second);
+        overview.sp.animationPreviews.push_back(-1);
     }
 }
 
@@ -283,6 +316,10 @@ void SpriteEditorOverview::refineSelection() {
             freeSplit(x1, y1, x2, y2);
         }
 
+        if (overview.gp.sel.free.mode == SelectionFreeMode_Components) {
+            freeComponents(x1, y1, x2, y2);
+        }
+
     } else if (overview.gp.sel.mode == SelectionMode_Tileset) {
         float x1 = ((int) (overview.mv.rect.pos[0] + overview.mv.tileset.size[0] / 2 - overview.gp.sel.tileset.offset[0]) / overview.gp.sel.tileset.size[0]) * overview.gp.sel.tileset.size[0] + overview.gp.sel.tileset.offset[0];
         float y1 = ((int) (overview.mv.rect.pos[1] + overview.mv.tileset.size[1] / 2 - overview.gp.sel.tileset.offset[1]) / overview.gp.sel.tileset.size[1]) * overview.gp.sel.tileset.size[1] + overview.gp.sel.tileset.offset[1];
@@ -326,42 +363,53 @@ void SpriteEditorOverview::freeNone(float x1, float y1, float x2, float y2) {
     overview.mv.subRects.push_back(rect);
 }
 
-bool SpriteEditorOverview::emptyColumn(float y1, float y2, float i) {
-    for (int j = y1; j < y2; j++) {
-        uint8_t * p = overview.sprite->getPixel(i, j);
-        if (*(p + 3)) {
-            return false;
-        }
-    }
+bool SpriteEditorOverview::clampToPixels(int & x1, int & y1, int & x2, int & y2) {
+    if (!overview.sprite->hasPixels())
+        return false;
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, overview.sprite->getWidth());
+    y2 = std::min(y2, overview.sprite->getHeight());
+    return x1 < x2 && y1 < y2;
+}
+
+bool SpriteEditorOverview::solidBounds(int & x1, int & y1, int & x2, int & y2) {
+    // Constant time once the index exists, otherwise a single streaming pass over the pixels
+    if (overview.sprite->hasAlphaIndex())
+        return overview.sprite->getAlphaIndex()->getBounds(x1, y1, x2, y2);
+
+    int c1 = x1, r1 = y1, c2 = x2, r2 = y2;
+    if (!clampToPixels(c1, r1, c2, r2) || !AlphaScan::getBounds(overview.sprite->getPixel(0, 0), overview.sprite->getWidth(), c1, r1, c2, r2))
+        return false;
+    x1 = c1;
+    y1 = r1;
+    x2 = c2;
+    y2 = r2;
     return true;
 }
 
-bool SpriteEditorOverview::emptyRow(float x1, float x2, float j) {
-    for (int i = x1; i < x2; i++) {
-        uint8_t * p = overview.sprite->getPixel(i, j);
-        if (*(p + 3)) {
-            return false;
-        }
+void SpriteEditorOverview::solidColumns(int x1, int y1, int x2, int y2, std::vector<uint8_t> & columns) {
+    columns.assign(std::max(x2 - x1, 0), 0);
+    if (overview.sprite->hasAlphaIndex()) {
+        AlphaIndex * index = overview.sprite->getAlphaIndex();
+        for (int i = x1; i < x2; i++)
+            columns[i - x1] = !index->isColumnEmpty(y1, y2, i);
+        return;
     }
-    return true;
+
+    // Columns of the clamped area, read row by row rather than one cache line per pixel
+    int c1 = x1, r1 = y1, c2 = x2, r2 = y2;
+    if (!clampToPixels(c1, r1, c2, r2))
+        return;
+    std::vector<uint8_t> rows, clamped;
+    AlphaScan::getOccupancy(overview.sprite->getPixel(0, 0), overview.sprite->getWidth(), c1, r1, c2, r2, rows, clamped);
+    std::copy(clamped.begin(), clamped.end(), columns.begin() + (c1 - x1));
 }
 
 void SpriteEditorOverview::freeCrop(float x1, float y1, float x2, float y2) {
-    int r1;
-    for (r1 = y1; emptyRow(x1, x2, r1) && r1 < y2; r1++);
-    if (r1 == y2)
+    int c1 = x1, r1 = y1, c2 = x2, r2 = y2;
+    if (!solidBounds(c1, r1, c2, r2))
         return;
-    int r2;
-    for (r2 = y2 - 1; emptyRow(x1, x2, r2) && r2 >= y1; r2--);
-    r2++;
-    
-    int c1;
-    for (c1 = x1; emptyColumn(y1, y2, c1) && c1 < x2; c1++);
-    if (c1 == x2)
-        return;
-    int c2;
-    for (c2 = x2 - 1; emptyColumn(y1, y2, c2) && c2 >= x1; c2--);
-    c2++;
 
     Rect rect = {
         {(float) c1 - overview.mv.tileset.size[0] / 2, (float) r1 - overview.mv.tileset.size[1] / 2},
@@ -377,21 +425,20 @@ void SpriteEditorOverview::freeSplit(float x1, float y1, float x2, float y2) {
     
     int c1, c2, nb = 0;
     bool previousEmpty = true;
+    std::vector<uint8_t> columns;
+    solidColumns(x1, y1, x2, y2, columns);
     for (int i = x1; i < x2; i++) {
-        bool empty = emptyColumn(y1, y2, i);
+        bool empty = !columns[i - (int) x1];
         if (!empty && previousEmpty) {
             c1 = i;
         }
         if ((empty && !previousEmpty) || (i == x2-1 && !empty)) {
             c2 = i + (i == x2-1 && !empty);
 
-            int r1;
-            for (r1 = y1; emptyRow(c1, c2, r1) && r1 < y2; r1++);
-            if (r1 == x2)
+            // The columns are solid, only the rows need tightening
+            int left = c1, r1 = y1, right = c2, r2 = y2;
+            if (!solidBounds(left, r1, right, r2))
                 return;
-            int r2;
-            for (r2 = y2 - 1; emptyRow(c1, c2, r2) && r2 >= y1; r2--);
-            r2++;
             
             Rect rect = {
                 {(float) c1 - overview.mv.tileset.size[0] / 2, (float) r1 - overview.mv.tileset.size[1] / 2},
@@ -405,6 +452,42 @@ void SpriteEditorOverview::freeSplit(float x1, float y1, float x2, float y2) {
     }
 }
 
+void SpriteEditorOverview::freeComponents(float x1, float y1, float x2, float y2) {
+    overview.mv.subRects.clear();
+
+    int c1 = x1, r1 = y1, c2 = x2, r2 = y2;
+    if (!clampToPixels(c1, r1, c2, r2))
+        return;
+
+    auto & components = overview.gp.sel.free.components;
+    int area[4] = {c1, r1, c2, r2};
+    if (components.sprite != overview.sprite || !std::equal(area, area + 4, components.area)
+        || components.mergeDistance != overview.gp.sel.free.mergeDistance || components.minArea != overview.gp.sel.free.minArea) {
+        // One sub-selection per connected group of solid pixels, in reading order so new animations play them in sheet order
+        SlicerSettings settings;
+        settings.mergeDistance = std::max(overview.gp.sel.free.mergeDistance, 0);
+        settings.minArea = std::max(overview.gp.sel.free.minArea, 1);
+        SpriteSlicer slicer(settings);
+
+        components.rects.clear();
+        for (const Slice & slice : slicer.slice(overview.sprite->getPixel(0, 0), overview.sprite->getWidth(), c1, r1, c2, r2)) {
+            Rect rect = {
+                {(float) slice.x1 - overview.mv.tileset.size[0] / 2, (float) slice.y1 - overview.mv.tileset.size[1] / 2},
+                {(float) slice.x2 - slice.x1, (float) slice.y2 - slice.y1},
+                {1, 1, 0, 1}
+            };
+            components.rects.push_back(rect);
+        }
+
+        components.sprite = overview.sprite;
+        std::copy(area, area + 4, components.area);
+        components.mergeDistance = overview.gp.sel.free.mergeDistance;
+        components.minArea = overview.gp.sel.free.minArea;
+    }
+
+    overview.mv.subRects = components.rects;
+}
+
 void SpriteEditorOverview::tilesetNoCrop(float x1, float y1, float x2, float y2) {
     overview.mv.subRects.clear();
 
@@ -423,23 +506,19 @@ void SpriteEditorOverview::tilesetNoCrop(float x1, float y1, float x2, float y2)
 void SpriteEditorOverview::tilesetCrop(float x1, float y1, float x2, float y2) {
     overview.mv.subRects.clear();
 
+    // Large grids are cropped again on every selection change, one query per cell, the index
+    // answers each in constant time and is worth building once for the sprite
+    const int indexedCells = 64;
+    int cells = (int) std::ceil((x2 - x1) / overview.gp.sel.tileset.size[0]) * (int) std::ceil((y2 - y1) / overview.gp.sel.tileset.size[1]);
+    if (cells >= indexedCells)
+        overview.sprite->buildAlphaIndex();
+
     for (int j = y1; j < y2; j += overview.gp.sel.tileset.size[1]) {
         for (int i = x1; i < x2; i += overview.gp.sel.tileset.size[0]) {
-            int r1;
-            for (r1 = j; emptyRow(i, i + overview.gp.sel.tileset.size[0], r1) && r1 < j + overview.gp.sel.tileset.size[1]; r1++);
-            if (r1 >= j + overview.gp.sel.tileset.size[1])
-                continue;
-            int r2;
-            for (r2 = j + overview.gp.sel.tileset.size[1] - 1; emptyRow(i, i + overview.gp.sel.tileset.size[0], r2) && r2 >= j; r2--);
-            r2++;
-            
-            int c1;
-            for (c1 = i; emptyColumn(j, j + overview.gp.sel.tileset.size[1], c1) && c1 < i + overview.gp.sel.tileset.size[0]; c1++);
-            if (c1 >= i + overview.gp.sel.tileset.size[0])
+            int c1 = i, r1 = j;
+            int c2 = i + overview.gp.sel.tileset.size[0], r2 = j + overview.gp.sel.tileset.size[1];
+            if (!solidBounds(c1, r1, c2, r2))
                 continue;
-            int c2;
-            for (c2 = i + overview.gp.sel.tileset.size[0] - 1; emptyColumn(j, j + overview.gp.sel.tileset.size[1], c2) && c2 >= i; c2--);
-            c2++;
             
             Rect rect = {
                 {(float) c1 - overview.mv.tileset.size[0] / 2, (float) r1 - overview.mv.tileset.size[1] / 2},
@@ -474,22 +553,14 @@ void SpriteEditorOverview::newAnimation() {
     std::cout << overview.sprite->toString() << std::endl;
 
     overview.sp.animations.push_back(animation);
-    SpritePreview * spritePreview = new SpritePreview(gb, overview.sprite, 32, 32);
-    spritePreview->setViewProjection(glm::mat4(1.0f));
-    spritePreview->getSpriteBox()->setSkin(overview.sp.selectedSkin);
-    spritePreview->getSpriteBox()->setAnimation(animation);
-    spritePreview->update();
-    overview.sp.animationPreviews.push_back(spritePreview);
+    overview.sp.animationPreviews.push_back(-1);
     
     if (!overview.sp.selectedAnimation) { // Create main preview if not already created
-        overview.sp.selectedAnimationPreview = new SpritePreview(gb, overview.sprite, 224, 224);
-        overview.sp.selectedAnimationPreview->setViewProjection(glm::mat4(1.0f));
-        overview.sp.selectedAnimationPreview->getSpriteBox()->setSkin(overview.sp.selectedSkin);
-        overview.sp.selectedAnimationPreview->getSpriteBox()->setAnimation(animation);
-        overview.sp.selectedAnimationPreview->update();
-    } else {
-        overview.sp.selectedAnimationPreview->getSpriteBox()->mimic(spritePreview->getSpriteBox());
+        overview.sp.selectedAnimationPreview = overview.sp.previewAtlas->add(overview.sprite, 224, 224);
     }
+    SpriteBox * selectedSpriteBox = overview.sp.previewAtlas->getSpriteBox(overview.sp.selectedAnimationPreview);
+    selectedSpriteBox->setSkin(overview.sp.selectedSkin);
+    selectedSpriteBox->setAnimation(animation);
     overview.sp.selectedAnimation = animation;
 }
 
@@ -662,6 +733,28 @@ void SpriteEditorOverview::showGeneralPanel() {
                 overview.gp.sel.free.mode = SelectionFreeMode_Split;
                 refineSelection();
             }
+            if (ImGui::RadioButton("Components", overview.gp.sel.free.mode == SelectionFreeMode_Components)) {
+                overview.gp.sel.free.mode = SelectionFreeMode_Components;
+                refineSelection();
+            }
+            if (overview.gp.sel.free.mode == SelectionFreeMode_Components) {
+                if (ImGui::InputInt("Merge distance", &overview.gp.sel.free.mergeDistance)) {
+                    overview.gp.sel.free.mergeDistance = std::max(overview.gp.sel.free.mergeDistance, 0);
+                    refineSelection();
+                }
+                if (ImGui::InputInt("Min area", &overview.gp.sel.free.minArea)) {
+                    overview.gp.sel.free.minArea = std::max(overview.gp.sel.free.minArea, 1);
+                    refineSelection();
+                }
+                if (ImGui::Button("Whole sheet") && overview.sprite) {
+                    // Selects the full sheet, its frames can then seed a new animation
+                    overview.mv.cur1[0] = -overview.mv.tileset.size[0] / 2;
+                    overview.mv.cur1[1] = -overview.mv.tileset.size[1] / 2;
+                    overview.mv.cur2[0] = overview.mv.tileset.size[0] / 2;
+                    overview.mv.cur2[1] = overview.mv.tileset.size[1] / 2;
+                    refineSelection();
+                }
+            }
             ImGui::PopID();
         } else {
             ImGui::PushID("Tileset options");
@@ -690,6 +783,34 @@ void SpriteEditorOverview::showGeneralPanel() {
             }
             ImGui::PopID();
         }
+
+
+        ImGui::Separator();
+
+        ImGui::Text("Frame pacing:");
+        ImGui::PushID("Frame pacing");
+        VkPresentModeKHR presentMode = gb->getPresentMode();
+        if (ImGui::RadioButton("FIFO", presentMode == VK_PRESENT_MODE_FIFO_KHR)) {
+            gb->setPresentMode(VK_PRESENT_MODE_FIFO_KHR);
+        }
+        ImGui::SameLine();
+        if (ImGui::RadioButton("Mailbox", presentMode == VK_PRESENT_MODE_MAILBOX_KHR)) {
+            gb->setPresentMode(VK_PRESENT_MODE_MAILBOX_KHR);
+        }
+        ImGui::SameLine();
+        if (ImGui::RadioButton("Immediate", presentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)) {
+            gb->setPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+        }
+        float fpsLimit = gb->getFramePacer()->getFpsLimit();
+        if (ImGui::InputFloat("FPS limit", &fpsLimit, 10.0f, 60.0f, "%.0f")) {
+            gb->getFramePacer()->setFpsLimit(fpsLimit);
+        }
+        bool lowLatency = gb->isLowLatency();
+        if (ImGui::Checkbox("Low latency", &lowLatency)) {
+            gb->setLowLatency(lowLatency);
+        }
+        ImGui::Checkbox("Show stats", &overview.mv.showStats);
+        ImGui::PopID();
     
     }
 
@@ -698,6 +819,24 @@ void SpriteEditorOverview::showGeneralPanel() {
     ImGui::PopStyleVar(2);
 }
 
+void SpriteEditorOverview::showStatsOverlay() {
+    if (!overview.mv.showStats) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(overview.mv.pos.x + 10, overview.mv.pos.y + 10), 0);
+    ImGui::SetNextWindowBgAlpha(0.5f);
+
+    ImGui::Begin("stats overlay", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoMove
+        | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing);
+
+    float frameTime = gb->getFramePacer()->getFrameTime();
+    ImGui::Text("Frame time: %.2f ms (%.0f FPS)", frameTime, frameTime > 0.0f ? 1000.0f / frameTime : 0.0f);
+    ImGui::Text("Input latency: ~%.2f ms", gb->getLatencyEstimate());
+
+    ImGui::End();
+}
+
 void SpriteEditorOverview::showMainView() {
     // Tileset view
     ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0);
@@ -714,7 +853,7 @@ void SpriteEditorOverview::showMainView() {
         
         overview.mv.seor->resize(overview.mv.size[0], overview.mv.size[1]);
         if (overview.mv.seor->getTexture()) {
-            ImGui::Image(overview.mv.seor->getTexture(), overview.mv.size);
+            ImGui::Image(overview.mv.seor->getTexture(), overview.mv.size, ImVec2(0, 0), overview.mv.seor->getTextureUV());
         }
         
         ImGuiIO& io = ImGui::GetIO();
@@ -797,6 +936,12 @@ void SpriteEditorOverview::showMainView() {
 }
 
 void SpriteEditorOverview::showSpritePanel() {
+    // Deleting rebuilds the atlas, done before any of its images is submitted this frame
+    if (overview.sp.deletePending && overview.sp.selectedAnimation) {
+        overview.sp.deletePending = false;
+        deleteAnimation();
+    }
+
     // sprite panel
     ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0);
     ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0);
@@ -836,39 +981,78 @@ void SpriteEditorOverview::showSpritePanel() {
         if (!overview.sp.selectedAnimation) {
             ImGui::Text("No animations available!");
         } else {
-            ImGui::Image(overview.sp.selectedAnimationPreview->getTexture(), ImVec2(224, 224));
+            // Thumbnails are added before any image of the atlas is submitted, a repack while adding
+            // one moves every slot and would leave the UVs already given to ImGui stale
+            acquireAnimationPreviews(overview.sp.previewBegin, overview.sp.previewEnd);
+
+            ImVec2 uv0, uv1;
+            overview.sp.previewAtlas->getUV(overview.sp.selectedAnimationPreview, uv0, uv1);
+            ImGui::Image(overview.sp.previewAtlas->getTexture(), ImVec2(224, 224), uv0, uv1);
 
             ImGui::PushID("Animations combo");
             ImGui::Text("Current animation:");
             if (ImGui::BeginCombo("", overview.sp.selectedAnimation->getName().c_str(), ImGuiComboFlags_HeightLargest)) {
-                for (int i = 0; i < overview.sp.animations.size(); i++) {
-                    Animation * animation = overview.sp.animations[i];
-                    SpritePreview * spritePreview = overview.sp.animationPreviews[i];
-                    bool isSelected = (overview.sp.selectedAnimation->getName() == animation->getName()); 
-                    
-                    ImGui::PushID(animation->getName().c_str());
-                    if (ImGui::Selectable("", isSelected, 0, ImVec2(0, 32))) {
-                        overview.sp.selectedAnimation = animation;
-                        overview.sp.selectedAnimationPreview->getSpriteBox()->mimic(spritePreview->getSpriteBox());
-                    }
-                    ImGui::SameLine();
-                    ImGui::Image(spritePreview->getTexture(), ImVec2(32, 32));
-                    ImGui::SameLine();
-                    ImGui::Text(animation->getName().c_str());
-                    ImGui::PopID();
+                // Only the visible rows are submitted, and only they hold a thumbnail, plus a few rows
+                // on each side so short scrolls don't create any. Rows scrolled in this frame get
+                // theirs on the next one
+                const int margin = 4;
+                float itemHeight = 32 + ImGui::GetStyle().ItemSpacing.y;
+                int count = overview.sp.animations.size();
+
+                if (ImGui::IsWindowAppearing()) {
+                    auto it = std::find(overview.sp.animations.begin(), overview.sp.animations.end(), overview.sp.selectedAnimation);
+                    ImGui::SetScrollY((it - overview.sp.animations.begin()) * itemHeight);
+                }
 
-                    if (isSelected) {
-                        ImGui::SetItemDefaultFocus();
+                int visibleBegin = count, visibleEnd = 0;
+                ImGuiListClipper clipper(count, itemHeight);
+                while (clipper.Step()) {
+                    visibleBegin = std::min(visibleBegin, clipper.DisplayStart);
+                    visibleEnd = std::max(visibleEnd, clipper.DisplayEnd);
+
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                        Animation * animation = overview.sp.animations[i];
+                        int preview = overview.sp.animationPreviews[i];
+                        bool isSelected = (overview.sp.selectedAnimation->getName() == animation->getName()); 
+                        
+                        ImGui::PushID(animation->getName().c_str());
+                        if (ImGui::Selectable("", isSelected, 0, ImVec2(0, 32))) {
+                            overview.sp.selectedAnimation = animation;
+                            SpriteBox * selectedSpriteBox = overview.sp.previewAtlas->getSpriteBox(overview.sp.selectedAnimationPreview);
+                            if (preview >= 0)
+                                selectedSpriteBox->mimic(overview.sp.previewAtlas->getSpriteBox(preview));
+                            else
+                                selectedSpriteBox->setAnimation(animation);
+                        }
+                        ImGui::SameLine();
+                        if (preview >= 0) {
+                            overview.sp.previewAtlas->getUV(preview, uv0, uv1);
+                            ImGui::Image(overview.sp.previewAtlas->getTexture(), ImVec2(32, 32), uv0, uv1);
+                        } else {
+                            ImGui::Dummy(ImVec2(32, 32));
+                        }
+                        ImGui::SameLine();
+                        ImGui::Text(animation->getName().c_str());
+                        ImGui::PopID();
+
+                        if (isSelected) {
+                            ImGui::SetItemDefaultFocus();
+                        }
                     }
                 }
+
+                overview.sp.previewBegin = std::max(visibleBegin - margin, 0);
+                overview.sp.previewEnd = std::min(visibleEnd + margin, count);
                 ImGui::EndCombo();
+            } else {
+                overview.sp.previewBegin = overview.sp.previewEnd = 0;
             }
             ImGui::PopID();
 
             ImGui::SameLine();
             
             if (ImGui::Button("Delete", ImVec2(-1.0f, 0.0f))) {
-                overview.sp.deleteRequest = true;
+                overview.sp.deletePending = true;
             }
         
             ImGui::PushID("Rename animation");
@@ -4,6 +4,7 @@
 #include <experimental/filesystem>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <algorithm>
 
 #define GLFW_INCLUDE_VULKAN
@@ -21,7 +22,9 @@
 #include "graphics_base.h"
 #include "drawable.h"
 #include "sprite.h"
-#include "sprite_preview.h"
+#include "alpha_scan.h"
+#include "sprite_slicer.h"
+#include "preview_atlas.h"
 #include "sprite_editor_overview_renderer.h"
 #include "file_browser.h"
 #include "graphics_quads.h"
@@ -33,7 +36,7 @@ namespace uengine::sprite_editor {
     };
 
     enum SelectionFreeMode {
-        SelectionFreeMode_None = 0, SelectionFreeMode_Crop = 1, SelectionFreeMode_Split = 2
+        SelectionFreeMode_None = 0, SelectionFreeMode_Crop = 1, SelectionFreeMode_Split = 2, SelectionFreeMode_Components = 3
     };
 
     struct Rect {
@@ -86,6 +89,16 @@ namespace uengine::sprite_editor {
 
                         struct Free {
                             SelectionFreeMode mode = SelectionFreeMode_None;
+                            int mergeDistance = 2; // Components mode, transparent pixels bridged inside a frame
+                            int minArea = 4;       // Components mode, solid pixels below which a frame is dropped
+
+                            struct Components {
+                                uengine::graphics::Sprite * sprite = nullptr;
+                                int area[4] = {0, 0, 0, 0};
+                                int mergeDistance = -1;
+                                int minArea = -1;
+                                std::vector<Rect> rects;
+                            } components; // Last slicing, reused while the selection is held on the same area
                         } free;
                         
                         struct Tileset {
@@ -113,6 +126,7 @@ namespace uengine::sprite_editor {
                     SpriteEditorOverviewRenderer * seor;
                     
                     float backgroundColor[4] = {0.0f, 1.0f, 1.0f, 1.0f};
+                    bool showStats = false;
 
                     struct Tileset {
                         glm::mat4 model;
@@ -146,6 +160,7 @@ namespace uengine::sprite_editor {
 
                     struct Rect rect = {{0, 0}, {0, 0}, {0, 0, 1, 1}}; // Current selection
                     std::vector<Rect> subRects; // Sub-selections attached to current selection
+                    std::vector<uengine::graphics::GraphicsQuads::Handle> selectionQuads; // Current selection then its sub-selections
                     bool currentSelectionChanged = false;
                     std::map<std::string, std::map<std::string, std::vector<Rect>>> rects; // Previous selections
                     bool previousSelectionChanged = false;
@@ -158,14 +173,17 @@ namespace uengine::sprite_editor {
                     uengine::graphics::Skin * selectedSkin = nullptr;
 
                     uengine::graphics::Animation * selectedAnimation = nullptr;
-                    uengine::graphics::SpritePreview * selectedAnimationPreview = nullptr;
+                    uengine::graphics::PreviewAtlas * previewAtlas = nullptr; // Every preview below is a thumbnail of it
+                    int selectedAnimationPreview = -1;
 
                     std::vector<uengine::graphics::Animation *> animations;
-                    std::vector<uengine::graphics::SpritePreview *> animationPreviews;
+                    std::vector<int> animationPreviews; // Thumbnail per animation, -1 while scrolled out of the list
+                    std::vector<int> shownAnimationPreviews; // Animations currently holding a thumbnail
+                    int previewBegin = 0, previewEnd = 0; // Rows to hold a thumbnail, shown in the list last frame plus a margin
+                    bool deletePending = false; // Selected animation deleted at the start of the next panel
 
                     char newAnimationName[100] = {0};
                     char newAnimationRename[100] = {0};
-                    bool deleteRequest = false;
                 } sp;
             } overview;
 
@@ -178,6 +196,9 @@ namespace uengine::sprite_editor {
             void fillSpritePanelData(uengine::graphics::Skin * skin = nullptr);
             void updateParameters();
             void updatePreviews();
+            int acquireAnimationPreview(int animation);
+            void acquireAnimationPreviews(int begin, int end); // Only animations in [begin, end) keep one
+            void releaseAnimationPreviews(int begin, int end); // Except the ones of animations in [begin, end)
             void updateCurrentSelection();
             void resetModel();
             void resetView();
@@ -189,11 +210,13 @@ namespace uengine::sprite_editor {
             glm::vec2 screenToWorld(glm::vec2 pos);
             void refineSelection();
             void correctSelection();
-            bool emptyColumn(float y1, float y2, float i);
-            bool emptyRow(float x1, float x2, float j);
+            bool clampToPixels(int & x1, int & y1, int & x2, int & y2); // False when the sprite has no pixels there
+            bool solidBounds(int & x1, int & y1, int & x2, int & y2);
+            void solidColumns(int x1, int y1, int x2, int y2, std::vector<uint8_t> & columns);
             void freeNone(float x1, float y1, float x2, float y2);
             void freeCrop(float x1, float y1, float x2, float y2);
             void freeSplit(float x1, float y1, float x2, float y2);
+            void freeComponents(float x1, float y1, float x2, float y2);
             void tilesetNoCrop(float x1, float y1, float x2, float y2);
             void tilesetCrop(float x1, float y1, float x2, float y2);
             void newAnimation();
@@ -205,6 +228,7 @@ namespace uengine::sprite_editor {
             void showGeneralPanel();
             void showMainView();
             void showSpritePanel();
+            void showStatsOverlay();
             void showMenuBar();
             void showMenuBarMenu();
     };
@@ -38,6 +38,7 @@ namespace uengine::sprite_editor {
         void render(VkCommandBuffer cb);
         void resize(int32_t width, int32_t height);
         ImTextureID getTexture();
+        ImVec2 getTextureUV(); // Bottom-right UV of the rendered area inside the texture
 
     private:
         uengine::graphics::GraphicsBase * gb;
@@ -49,24 +50,20 @@ namespace uengine::sprite_editor {
         uengine::graphics::GraphicsQuads * currentSelectionQuads;
         uengine::graphics::GraphicsQuads * previousSelectionQuads;
 
+        // The offscreen image is kept as long as none of its inputs changed
+        uint64_t revision = 1; // Background color and offscreen size
+        std::array<uint64_t, 4> renderedRevisions = {}; // Own, grid, current and previous selection quads
+
         // Offscreen methods
         
         struct Offscreen {
-            int32_t width=0, height=0;
-            VkDeviceMemory mem;
-            VkImage image;
-            VkImageView view;
-            VkFramebuffer frameBuffer;		
-            VkSampler sampler;
+            int32_t width=0, height=0; // Rendered area
+            uengine::graphics::OffscreenTarget target; // Allocated image, grown with some slack
             ImTextureID texture = nullptr;
         } offscreen;
 
         void setupOffscreen(int32_t width, int32_t height);
         void destroyOffscreen();
-        
-        // Renderpass methods
-        
-        void setupRenderPass();
     };
 
 }